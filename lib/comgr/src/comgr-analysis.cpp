@@ -0,0 +1,487 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-analysis.h"
+#include "comgr-disassembly.h"
+#include "comgr-metadata.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include <optional>
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace COMGR {
+namespace analysis {
+
+namespace {
+
+// Every decoded instruction is counted in exactly one class, so the class
+// counts of a kernel always add up to its instruction count.
+enum InstructionClass {
+  IC_VALU,
+  IC_SALU,
+  IC_VMEMLoad,
+  IC_VMEMStore,
+  IC_VMEMAtomic,
+  IC_SMEM,
+  IC_LDS,
+  IC_Export,
+  IC_Branch,
+  IC_Waitcnt,
+  IC_Other,
+  IC_Count
+};
+
+const char *InstructionClassNames[IC_Count] = {
+    "valu", "salu",   "vmem_load", "vmem_store", "vmem_atomic", "smem",
+    "lds",  "export", "branch",    "waitcnt",    "other"};
+
+struct InstructionMix {
+  uint64_t Counts[IC_Count] = {};
+  uint64_t Total = 0;
+
+  void add(InstructionClass Class) {
+    ++Counts[Class];
+    ++Total;
+  }
+};
+
+struct FunctionSymbol {
+  StringRef Name;
+  SectionRef Section;
+  uint64_t Address;
+  uint64_t Size;
+};
+
+// The object file and MC state shared by the analyses of one code object.
+struct CodeObject {
+  std::string IsaName;
+  std::unique_ptr<DisassemblyInfo> DisasmInfo;
+  std::unique_ptr<ObjectFile> Obj;
+
+  const ELFObjectFileBase &getELF() const {
+    return *cast<ELFObjectFileBase>(Obj.get());
+  }
+};
+
+} // namespace
+
+static InstructionClass classifyInstruction(const MCInstrInfo &MII,
+                                            const MCInst &Inst) {
+  const MCInstrDesc &Desc = MII.get(Inst.getOpcode());
+  StringRef Name = MII.getName(Inst.getOpcode());
+
+  if (Name.startswith("S_WAITCNT") || Name.startswith("S_WAIT_")) {
+    return IC_Waitcnt;
+  }
+  if (Desc.isBranch() || Desc.isIndirectBranch() || Desc.isCall() ||
+      Desc.isReturn()) {
+    return IC_Branch;
+  }
+  if (Name.startswith("EXP")) {
+    return IC_Export;
+  }
+  if (Name.startswith("DS_")) {
+    return IC_LDS;
+  }
+  if (Name.startswith("BUFFER_") || Name.startswith("TBUFFER_") ||
+      Name.startswith("GLOBAL_") || Name.startswith("FLAT_") ||
+      Name.startswith("SCRATCH_") || Name.startswith("IMAGE_")) {
+    if (Desc.mayLoad() && Desc.mayStore()) {
+      return IC_VMEMAtomic;
+    }
+    return Desc.mayStore() ? IC_VMEMStore : IC_VMEMLoad;
+  }
+  if (Name.startswith("S_")) {
+    if (Desc.mayLoad() || Desc.mayStore()) {
+      return IC_SMEM;
+    }
+    return IC_SALU;
+  }
+  if (Name.startswith("V_")) {
+    return IC_VALU;
+  }
+  return IC_Other;
+}
+
+// Collect the function symbols of Obj, or only its kernel entry points if
+// KernelsOnly is set. Code object V3 and later mark a kernel with a
+// "<name>.kd" kernel descriptor symbol; code object V2 uses the
+// STT_AMDGPU_HSA_KERNEL symbol type and prefixes the kernel code with a 256
+// byte amd_kernel_code_t, which is skipped.
+static amd_comgr_status_t
+collectFunctions(const ELFObjectFileBase &Obj, bool KernelsOnly,
+                 std::vector<FunctionSymbol> &Functions) {
+  auto Symbols = Obj.symbols();
+  if (Symbols.begin() == Symbols.end()) {
+    Symbols = Obj.getDynamicSymbolIterators();
+  }
+
+  StringSet<> Descriptors;
+  for (ELFSymbolRef Sym : Symbols) {
+    Expected<StringRef> NameOrErr = Sym.getName();
+    if (!NameOrErr) {
+      consumeError(NameOrErr.takeError());
+      return AMD_COMGR_STATUS_ERROR;
+    }
+    if (Sym.getELFType() == ELF::STT_OBJECT && NameOrErr->endswith(".kd")) {
+      Descriptors.insert(NameOrErr->drop_back(3));
+    }
+  }
+
+  for (ELFSymbolRef Sym : Symbols) {
+    Expected<StringRef> NameOrErr = Sym.getName();
+    if (!NameOrErr) {
+      consumeError(NameOrErr.takeError());
+      return AMD_COMGR_STATUS_ERROR;
+    }
+
+    uint64_t Skip = 0;
+    if (Sym.getELFType() == ELF::STT_AMDGPU_HSA_KERNEL) {
+      Skip = 256;
+    } else if (Sym.getELFType() != ELF::STT_FUNC ||
+               (KernelsOnly && !Descriptors.count(*NameOrErr))) {
+      continue;
+    }
+
+    Expected<uint64_t> AddressOrErr = Sym.getAddress();
+    if (!AddressOrErr) {
+      consumeError(AddressOrErr.takeError());
+      return AMD_COMGR_STATUS_ERROR;
+    }
+
+    Expected<section_iterator> SectionOrErr = Sym.getSection();
+    if (!SectionOrErr) {
+      consumeError(SectionOrErr.takeError());
+      return AMD_COMGR_STATUS_ERROR;
+    }
+    if (*SectionOrErr == Obj.section_end() || Sym.getSize() <= Skip) {
+      continue;
+    }
+
+    Functions.push_back({*NameOrErr, **SectionOrErr, *AddressOrErr + Skip,
+                         Sym.getSize() - Skip});
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+static amd_comgr_status_t getFunctionBytes(const FunctionSymbol &Function,
+                                           ArrayRef<uint8_t> &Bytes) {
+  Expected<StringRef> ContentsOrErr = Function.Section.getContents();
+  if (!ContentsOrErr) {
+    consumeError(ContentsOrErr.takeError());
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  uint64_t Start = Function.Address - Function.Section.getAddress();
+  if (Start + Function.Size > ContentsOrErr->size()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  Bytes = ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(ContentsOrErr->data()) + Start,
+      Function.Size);
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+static amd_comgr_status_t openCodeObject(DataObject *DataP, CodeObject &CO) {
+  if (auto Status = metadata::getElfIsaName(DataP, CO.IsaName)) {
+    return Status;
+  }
+
+  TargetIdentifier Ident;
+  if (auto Status = parseTargetIdentifier(CO.IsaName, Ident)) {
+    return Status;
+  }
+
+  amd_comgr_disassembly_info_t DisasmInfoT;
+  if (auto Status = DisassemblyInfo::create(Ident, nullptr, nullptr, nullptr,
+                                            &DisasmInfoT)) {
+    return Status;
+  }
+  CO.DisasmInfo.reset(DisassemblyInfo::convert(DisasmInfoT));
+
+  auto ObjOrErr = ObjectFile::createELFObjectFile(
+      MemoryBufferRef(StringRef(DataP->Data, DataP->Size), ""));
+  if (!ObjOrErr) {
+    consumeError(ObjOrErr.takeError());
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  CO.Obj = std::move(*ObjOrErr);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+static msgpack::DocNode getMixNode(msgpack::Document &Doc,
+                                   const InstructionMix &Mix) {
+  auto MixNode = Doc.getMapNode();
+  for (unsigned I = 0; I < IC_Count; ++I) {
+    MixNode[InstructionClassNames[I]] = Doc.getNode(Mix.Counts[I]);
+  }
+  return MixNode;
+}
+
+amd_comgr_status_t analyzeInstructionMix(DataObject *DataP,
+                                         std::string &Blob) {
+  CodeObject CO;
+  if (auto Status = openCodeObject(DataP, CO)) {
+    return Status;
+  }
+  DisassemblyInfo &DisasmInfo = *CO.DisasmInfo;
+
+  std::vector<FunctionSymbol> Kernels;
+  if (auto Status =
+          collectFunctions(CO.getELF(), /*KernelsOnly=*/true, Kernels)) {
+    return Status;
+  }
+
+  msgpack::Document Doc;
+  auto Root = Doc.getRoot().getMap(/*Convert=*/true);
+  Root["amdcomgr.isa"] = Doc.getNode(CO.IsaName, /*Copy=*/true);
+  auto KernelsNode = Doc.getArrayNode();
+
+  for (const FunctionSymbol &Kernel : Kernels) {
+    ArrayRef<uint8_t> Bytes;
+    if (auto Status = getFunctionBytes(Kernel, Bytes)) {
+      return Status;
+    }
+
+    // Decode the kernel once, remembering the class of each instruction so
+    // the loop bodies found by the backward branches can be counted after.
+    std::vector<std::pair<uint64_t, InstructionClass>> Instructions;
+    std::vector<std::pair<uint64_t, uint64_t>> Loops;
+    InstructionMix Mix;
+    uint64_t Size;
+    for (uint64_t Index = 0; Index < Bytes.size(); Index += Size) {
+      uint64_t Address = Kernel.Address + Index;
+      MCInst Inst;
+      InstructionClass Class = IC_Other;
+      if (DisasmInfo.DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
+                                            Address, nulls()) ==
+          MCDisassembler::Success) {
+        Class = classifyInstruction(*DisasmInfo.MII, Inst);
+
+        uint64_t Target;
+        if (Class == IC_Branch && DisasmInfo.MIA &&
+            DisasmInfo.MIA->evaluateBranch(Inst, Address, Size, Target) &&
+            Target >= Kernel.Address && Target <= Address) {
+          Loops.emplace_back(Target, Address + Size);
+        }
+      }
+      // AMDGPU instructions are at least one dword; make sure we advance on
+      // undecodable words.
+      if (!Size) {
+        Size = 4;
+      }
+      Mix.add(Class);
+      Instructions.emplace_back(Address, Class);
+    }
+
+    InstructionMix LoopMix;
+    for (const auto &Instruction : Instructions) {
+      for (const auto &Loop : Loops) {
+        if (Instruction.first >= Loop.first &&
+            Instruction.first < Loop.second) {
+          LoopMix.add(Instruction.second);
+          break;
+        }
+      }
+    }
+
+    auto KernelNode = Doc.getMapNode();
+    KernelNode[".name"] = Doc.getNode(Kernel.Name, /*Copy=*/true);
+    KernelNode[".code_size"] = Doc.getNode(Kernel.Size);
+    KernelNode[".instruction_count"] = Doc.getNode(Mix.Total);
+    KernelNode[".instruction_mix"] = getMixNode(Doc, Mix);
+    KernelNode[".loop_count"] = Doc.getNode(uint64_t(Loops.size()));
+    KernelNode[".loop_instruction_count"] = Doc.getNode(LoopMix.Total);
+    KernelNode[".loop_instruction_mix"] = getMixNode(Doc, LoopMix);
+    KernelsNode.push_back(KernelNode);
+  }
+
+  Root["amdcomgr.kernels"] = KernelsNode;
+  Doc.writeToBlob(Blob);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace analysis
+
+namespace {
+
+struct DecodedInstruction {
+  uint64_t Address;
+  uint64_t Size;
+  // The instruction may transfer control somewhere other than the next
+  // instruction, so the next instruction starts a new block.
+  bool EndsBlock;
+  // Control may continue with the next instruction.
+  bool FallsThrough;
+  bool IsBranch;
+  bool IsCall;
+  bool HasTarget;
+  uint64_t Target;
+};
+
+} // namespace
+
+static void buildFunctionCFG(const DisassemblyInfo &DisasmInfo,
+                             const analysis::FunctionSymbol &Function,
+                             ArrayRef<uint8_t> Bytes, CFGFunction &CFG) {
+  uint64_t FunctionEnd = Function.Address + Function.Size;
+  std::vector<DecodedInstruction> Instructions;
+  std::vector<uint64_t> Leaders = {Function.Address};
+
+  uint64_t Size;
+  for (uint64_t Index = 0; Index < Bytes.size(); Index += Size) {
+    DecodedInstruction I = {};
+    I.Address = Function.Address + Index;
+    I.FallsThrough = true;
+    MCInst Inst;
+    if (DisasmInfo.DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
+                                          I.Address, nulls()) ==
+        MCDisassembler::Success) {
+      const MCInstrDesc &Desc = DisasmInfo.MII->get(Inst.getOpcode());
+      I.IsBranch = Desc.isBranch() || Desc.isIndirectBranch();
+      I.IsCall = Desc.isCall();
+      I.EndsBlock = I.IsBranch || Desc.isTerminator() || Desc.isReturn();
+      I.FallsThrough = !Desc.isBarrier() && !Desc.isReturn();
+      if ((I.IsBranch || I.IsCall) && DisasmInfo.MIA) {
+        I.HasTarget =
+            DisasmInfo.MIA->evaluateBranch(Inst, I.Address, Size, I.Target);
+      }
+    }
+    if (!Size) {
+      Size = 4;
+    }
+    I.Size = Size;
+
+    if (I.EndsBlock && I.Address + I.Size < FunctionEnd) {
+      Leaders.push_back(I.Address + I.Size);
+    }
+    if (I.IsBranch && I.HasTarget && I.Target >= Function.Address &&
+        I.Target < FunctionEnd) {
+      Leaders.push_back(I.Target);
+    }
+    Instructions.push_back(I);
+  }
+
+  llvm::sort(Leaders);
+  Leaders.erase(std::unique(Leaders.begin(), Leaders.end()), Leaders.end());
+
+  // Split the instruction stream at the leaders, remembering the last
+  // instruction of each block to derive its successors.
+  std::vector<const DecodedInstruction *> BlockTerminators;
+  for (const DecodedInstruction &I : Instructions) {
+    if (CFG.Blocks.empty() ||
+        std::binary_search(Leaders.begin(), Leaders.end(), I.Address)) {
+      CFG.Blocks.push_back({I.Address, I.Address});
+      BlockTerminators.push_back(nullptr);
+    }
+    CFG.Blocks.back().end = I.Address + I.Size;
+    BlockTerminators.back() = &I;
+
+    if (I.IsCall) {
+      CFG.Calls.push_back({CFG.Blocks.size() - 1, I.Address,
+                           I.HasTarget ? I.Target : 0, I.HasTarget});
+    }
+  }
+
+  auto FindBlock = [&](uint64_t Address) -> std::optional<size_t> {
+    auto It = llvm::partition_point(
+        CFG.Blocks,
+        [&](const amd_comgr_cfg_block_t &B) { return B.start < Address; });
+    if (It == CFG.Blocks.end() || It->start != Address) {
+      return std::nullopt;
+    }
+    return It - CFG.Blocks.begin();
+  };
+
+  for (size_t B = 0, E = CFG.Blocks.size(); B != E; ++B) {
+    const DecodedInstruction &Last = *BlockTerminators[B];
+    std::optional<size_t> TargetBlock;
+    if (Last.IsBranch && Last.HasTarget) {
+      TargetBlock = FindBlock(Last.Target);
+      if (TargetBlock) {
+        CFG.Edges.push_back({B, *TargetBlock});
+      }
+    }
+    if (Last.FallsThrough && B + 1 != E && TargetBlock != B + 1) {
+      CFG.Edges.push_back({B, B + 1});
+    }
+  }
+}
+
+amd_comgr_status_t CFGInfo::create(DataObject *DataP,
+                                   amd_comgr_cfg_info_t *CFGInfoT) {
+  analysis::CodeObject CO;
+  if (auto Status = analysis::openCodeObject(DataP, CO)) {
+    return Status;
+  }
+
+  std::vector<analysis::FunctionSymbol> Functions;
+  if (auto Status = analysis::collectFunctions(
+          CO.getELF(), /*KernelsOnly=*/false, Functions)) {
+    return Status;
+  }
+
+  std::unique_ptr<CFGInfo> CFG(new (std::nothrow) CFGInfo());
+  if (!CFG) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  CFG->Functions.resize(Functions.size());
+  for (size_t I = 0, E = Functions.size(); I != E; ++I) {
+    ArrayRef<uint8_t> Bytes;
+    if (auto Status = analysis::getFunctionBytes(Functions[I], Bytes)) {
+      return Status;
+    }
+
+    CFGFunction &Function = CFG->Functions[I];
+    Function.Name = Functions[I].Name.str();
+    Function.Address = Functions[I].Address;
+    Function.Size = Functions[I].Size;
+    buildFunctionCFG(*CO.DisasmInfo, Functions[I], Bytes, Function);
+  }
+
+  *CFGInfoT = CFGInfo::convert(CFG.release());
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace COMGR
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_ANALYSIS_H
+#define COMGR_ANALYSIS_H
+
+#include "comgr.h"
+
+namespace COMGR {
+namespace analysis {
+
+/// Disassemble every kernel in the ELF code object @p DataP and encode a
+/// MsgPack document describing its static instruction mix into @p Blob.
+amd_comgr_status_t analyzeInstructionMix(DataObject *DataP, std::string &Blob);
+
+} // namespace analysis
+
+struct CFGFunction {
+  std::string Name;
+  uint64_t Address;
+  uint64_t Size;
+  std::vector<amd_comgr_cfg_block_t> Blocks;
+  std::vector<amd_comgr_cfg_edge_t> Edges;
+  std::vector<amd_comgr_cfg_call_t> Calls;
+};
+
+/// The control flow graphs of all functions of a code object, computed once
+/// when the object is created.
+struct CFGInfo {
+  static amd_comgr_cfg_info_t convert(CFGInfo *CFG) {
+    amd_comgr_cfg_info_t Handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(CFG))};
+    return Handle;
+  }
+
+  static CFGInfo *convert(amd_comgr_cfg_info_t CFG) {
+    return reinterpret_cast<CFGInfo *>(CFG.handle);
+  }
+
+  static amd_comgr_status_t create(DataObject *CodeObject,
+                                   amd_comgr_cfg_info_t *CFGInfoT);
+
+  std::vector<CFGFunction> Functions;
+};
+
+} // namespace COMGR
+
+#endif // COMGR_ANALYSIS_H
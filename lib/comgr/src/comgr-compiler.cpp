@@ -39,6 +39,7 @@
 #include "comgr-compiler.h"
 #include "comgr-device-libs.h"
 #include "comgr-env.h"
+#include "comgr-statistics.h"
 #include "lld/Common/CommonLinkerContext.h"
 #include "lld/Common/Driver.h"
 #include "clang/Basic/Version.h"
@@ -52,11 +53,18 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/FrontendTool/Utils.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/LTO/LTO.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
@@ -72,18 +80,31 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCTargetOptions.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/ObjCopy/ConfigManager.h"
+#include "llvm/ObjCopy/ObjCopy.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Caching.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/IPO/GlobalDCE.h"
+#include "llvm/Transforms/IPO/Internalize.h"
 
 #include "time-stat/ts-interface.h"
 
 #include <csignal>
+#include <list>
+#include <mutex>
 
 using namespace llvm;
 using namespace llvm::opt;
@@ -347,8 +368,11 @@ getOutputStream(AssemblerInvocation &Opts, DiagnosticsEngine &Diags,
   return Out;
 }
 
+using SMDiagnosticHandler = function_ref<void(const SMDiagnostic &)>;
+
 static bool executeAssemblerImpl(AssemblerInvocation &Opts,
-                                 DiagnosticsEngine &Diags, raw_ostream &LogS) {
+                                 DiagnosticsEngine &Diags,
+                                 SMDiagnosticHandler HandleDiag) {
   // Get the target specific parser.
   std::string Error;
   const Target *TheTarget = TargetRegistry::lookupTarget(Opts.Triple, Error);
@@ -366,10 +390,10 @@ static bool executeAssemblerImpl(AssemblerInvocation &Opts,
 
   SourceMgr SrcMgr;
   SrcMgr.setDiagHandler(
-      [](const SMDiagnostic &SMDiag, void *LogS) {
-        SMDiag.print("", *(raw_ostream *)LogS, /* ShowColors */ false);
+      [](const SMDiagnostic &SMDiag, void *HandleDiag) {
+        (*static_cast<SMDiagnosticHandler *>(HandleDiag))(SMDiag);
       },
-      &LogS);
+      &HandleDiag);
 
   // Tell SrcMgr about this buffer, which is what the parser will pick up.
   SrcMgr.AddNewSourceBuffer(std::move(*Buffer), SMLoc());
@@ -524,8 +548,9 @@ static bool executeAssemblerImpl(AssemblerInvocation &Opts,
 }
 
 static bool executeAssembler(AssemblerInvocation &Opts,
-                             DiagnosticsEngine &Diags, raw_ostream &LogS) {
-  bool Failed = executeAssemblerImpl(Opts, Diags, LogS);
+                             DiagnosticsEngine &Diags,
+                             SMDiagnosticHandler HandleDiag) {
+  bool Failed = executeAssemblerImpl(Opts, Diags, HandleDiag);
 
   // Delete output file if there were errors.
   if (Failed && Opts.OutputPath != "-") {
@@ -550,7 +575,8 @@ static SmallString<128> getFilePath(DataObject *Object, StringRef Dir) {
 }
 
 static amd_comgr_status_t inputFromFile(DataObject *Object, StringRef Path) {
-  ProfilePoint Point("FileIO");
+  static ProfilePointId FileIOId("FileIO");
+  ProfilePoint Point(FileIOId);
   auto BufOrError = MemoryBuffer::getFile(Path);
   if (std::error_code EC = BufOrError.getError()) {
     return AMD_COMGR_STATUS_ERROR;
@@ -563,13 +589,16 @@ static amd_comgr_status_t outputToFile(StringRef Data, StringRef Path) {
   SmallString<128> DirPath = Path;
   path::remove_filename(DirPath);
   {
-    ProfilePoint Point("CreateDir");
+    static ProfilePointId CreateDirId("CreateDir");
+    ProfilePoint Point(CreateDirId);
     if (fs::create_directories(DirPath)) {
       return AMD_COMGR_STATUS_ERROR;
     }
   }
   std::error_code EC;
-  ProfilePoint Point("FileIO");
+  static ProfilePointId FileIOId("FileIO");
+  ProfilePoint Point(FileIOId);
+  statistics::recordTempFile();
   raw_fd_ostream OS(Path, EC, fs::OF_None);
   if (EC) {
     return AMD_COMGR_STATUS_ERROR;
@@ -618,6 +647,7 @@ static amd_comgr_status_t linkWithLLD(llvm::ArrayRef<const char *> Args,
   LLDArgs.push_back("--threads=1");
 
   ArrayRef<const char *> ArgRefs = llvm::ArrayRef(LLDArgs);
+  statistics::recordLLDInvocation();
   bool LLDRet = lld::elf::link(ArgRefs, LogS, LogE, false, false);
   lld::CommonLinkerContext::destroy();
   if (!LLDRet) {
@@ -626,6 +656,269 @@ static amd_comgr_status_t linkWithLLD(llvm::ArrayRef<const char *> Args,
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+// Prefer zstd for compressed debug sections, but fall back to zlib if LLVM
+// was built without it.
+static DebugCompressionType getDebugCompressionType() {
+  return compression::zstd::isAvailable() ? DebugCompressionType::Zstd
+                                          : DebugCompressionType::Zlib;
+}
+
+static const char *getCompressDebugSectionsOption() {
+  return getDebugCompressionType() == DebugCompressionType::Zstd
+             ? "--compress-debug-sections=zstd"
+             : "--compress-debug-sections=zlib";
+}
+
+static amd_comgr_status_t runObjCopy(const objcopy::ConfigManager &Config,
+                                     object::Binary &Input,
+                                     SmallVectorImpl<char> &Output,
+                                     raw_ostream &LogS) {
+  raw_svector_ostream OS(Output);
+  if (Error Err = objcopy::executeObjcopyOnBinary(Config, Input, OS)) {
+    LogS << "Error: splitting debug info failed: " << toString(std::move(Err))
+         << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+// Move the debug sections of Executable into DebugInfo, the equivalent of
+// "objcopy --only-keep-debug" followed by "objcopy --strip-debug
+// --add-gnu-debuglink". Section addresses are unchanged, so DebugInfo can be
+// used to symbolize addresses of the stripped executable.
+static amd_comgr_status_t splitDebugInfo(DataObject *Executable,
+                                         DataObject *DebugInfo,
+                                         raw_ostream &LogS) {
+  auto ObjOrErr = object::ObjectFile::createObjectFile(MemoryBufferRef(
+      StringRef(Executable->Data, Executable->Size), Executable->Name));
+  if (!ObjOrErr) {
+    LogS << "Error: " << toString(ObjOrErr.takeError()) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  objcopy::ConfigManager DebugConfig;
+  DebugConfig.Common.OnlyKeepDebug = true;
+  DebugConfig.Common.CompressionType = getDebugCompressionType();
+  SmallVector<char, 0> DebugBuffer;
+  if (auto Status = runObjCopy(DebugConfig, **ObjOrErr, DebugBuffer, LogS)) {
+    return Status;
+  }
+
+  objcopy::ConfigManager StripConfig;
+  StripConfig.Common.StripDebug = true;
+  StripConfig.Common.AddGnuDebugLink = DebugInfo->Name;
+  StripConfig.Common.GnuDebugLinkCRC32 = crc32(arrayRefFromStringRef(
+      StringRef(DebugBuffer.data(), DebugBuffer.size())));
+  SmallVector<char, 0> StrippedBuffer;
+  if (auto Status =
+          runObjCopy(StripConfig, **ObjOrErr, StrippedBuffer, LogS)) {
+    return Status;
+  }
+
+  if (auto Status = DebugInfo->setData(
+          StringRef(DebugBuffer.data(), DebugBuffer.size()))) {
+    return Status;
+  }
+  return Executable->setData(
+      StringRef(StrippedBuffer.data(), StrippedBuffer.size()));
+}
+
+// Internalize every function definition other than the root kernels, and
+// remove everything which is no longer reachable from them. Global variables
+// with external linkage may be accessed by the host, so they are preserved.
+// M must be the whole program, as functions called from other modules would
+// be removed as well.
+static void eliminateUnusedKernels(Module &M, ArrayRef<std::string> Roots) {
+  StringSet<> RootSet;
+  for (auto &Root : Roots) {
+    RootSet.insert(Root);
+  }
+
+  internalizeModule(M, [&](const GlobalValue &GV) {
+    return !isa<Function>(GV) || RootSet.contains(GV.getName());
+  });
+
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PassBuilder PB;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  ModulePassManager MPM;
+  MPM.addPass(GlobalDCEPass());
+  MPM.run(M, MAM);
+}
+
+// Move the functions named in Order to the front of M, in that order, each
+// followed by the functions it calls which are not placed yet. Code generation
+// emits functions in module order, so the code executed together ends up
+// close together in the code object.
+static void orderFunctions(Module &M, ArrayRef<std::string> Order) {
+  std::vector<Function *> Placed;
+  SmallPtrSet<Function *, 32> Visited;
+  for (auto &Name : Order) {
+    Function *Root = M.getFunction(Name);
+    if (!Root) {
+      continue;
+    }
+    SmallVector<Function *, 16> Worklist = {Root};
+    while (!Worklist.empty()) {
+      Function *F = Worklist.pop_back_val();
+      if (F->isDeclaration() || !Visited.insert(F).second) {
+        continue;
+      }
+      Placed.push_back(F);
+      // Visit the callees in reverse so that the first one called is placed
+      // first.
+      SmallVector<Function *, 8> Callees;
+      for (auto &I : instructions(F)) {
+        if (auto *Call = dyn_cast<CallBase>(&I)) {
+          if (Function *Callee = Call->getCalledFunction()) {
+            Callees.push_back(Callee);
+          }
+        }
+      }
+      Worklist.append(Callees.rbegin(), Callees.rend());
+    }
+  }
+
+  auto &Functions = M.getFunctionList();
+  auto Pos = Functions.begin();
+  for (Function *F : Placed) {
+    if (F->getIterator() == Pos) {
+      ++Pos;
+    } else {
+      Functions.splice(Pos, Functions, F->getIterator());
+    }
+  }
+}
+
+// Write the bitcode in Input to Path, laying out functions in Order.
+static amd_comgr_status_t
+outputOrderedBitcodeToFile(DataObject *Input, StringRef Path,
+                           ArrayRef<std::string> Order, raw_ostream &LogS) {
+  LLVMContext Context;
+  auto ModOrErr = parseBitcodeFile(
+      MemoryBufferRef(StringRef(Input->Data, Input->Size), Input->Name),
+      Context);
+  if (!ModOrErr) {
+    LogS << "Error: " << toString(ModOrErr.takeError()) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  orderFunctions(**ModOrErr, Order);
+
+  SmallString<0> OutBuf;
+  raw_svector_ostream OS(OutBuf);
+  WriteBitcodeToFile(**ModOrErr, OS);
+  return outputToFile(OutBuf, Path);
+}
+
+// Add the bitcode in Input to LTO. Bitcode without a module summary, i.e. not
+// compiled with -flto=thin, is summarized first so that it takes part in
+// ThinLTO rather than being merged into a single regular LTO partition. If
+// Roots is not empty, functions other than the root kernels are neither
+// exported nor visible outside of LTO, so that LTO, which sees the whole
+// program, internalizes them and removes those left unused. Symbols in
+// ObjectRefs are referenced by the relocatable inputs linked with the LTO
+// output, and so are kept visible to them.
+static amd_comgr_status_t addThinLTOInput(lto::LTO &LTO, DataObject *Input,
+                                          const StringSet<> &Roots,
+                                          const StringSet<> &ObjectRefs,
+                                          StringSet<> &Defined,
+                                          std::list<SmallString<0>> &Buffers,
+                                          raw_ostream &LogS) {
+  MemoryBufferRef Buffer(StringRef(Input->Data, Input->Size), Input->Name);
+
+  auto LTOInfoOrErr = getBitcodeLTOInfo(Buffer);
+  if (!LTOInfoOrErr) {
+    LogS << "Error: " << toString(LTOInfoOrErr.takeError()) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  if (!LTOInfoOrErr->HasSummary) {
+    LLVMContext Context;
+    auto ModOrErr = parseBitcodeFile(Buffer, Context);
+    if (!ModOrErr) {
+      LogS << "Error: " << toString(ModOrErr.takeError()) << "\n";
+      return AMD_COMGR_STATUS_ERROR;
+    }
+
+    ProfileSummaryInfo PSI(**ModOrErr);
+    ModuleSummaryIndex Index =
+        buildModuleSummaryIndex(**ModOrErr, nullptr, &PSI);
+    Buffers.emplace_back();
+    raw_svector_ostream OS(Buffers.back());
+    WriteBitcodeToFile(**ModOrErr, OS, false, &Index);
+    Buffer = MemoryBufferRef(Buffers.back(), Input->Name);
+  }
+
+  auto FileOrErr = lto::InputFile::create(Buffer);
+  if (!FileOrErr) {
+    LogS << "Error: " << toString(FileOrErr.takeError()) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  // As in lld, the first definition of a symbol prevails. Symbols which are
+  // not hidden are exported from the executable, except for functions other
+  // than the root kernels, and everything else may be internalized.
+  std::vector<lto::SymbolResolution> Resolutions;
+  for (const lto::InputFile::Symbol &Sym : (*FileOrErr)->symbols()) {
+    lto::SymbolResolution Res;
+    if (!Sym.isUndefined()) {
+      bool IsRoot = Roots.empty() || !Sym.isExecutable() ||
+                    Roots.contains(Sym.getName());
+      Res.Prevailing = Defined.insert(Sym.getName()).second;
+      Res.ExportDynamic =
+          IsRoot && Sym.getVisibility() != GlobalValue::HiddenVisibility;
+      Res.VisibleToRegularObj =
+          Res.Prevailing &&
+          (Res.ExportDynamic || ObjectRefs.contains(Sym.getName()));
+      Res.FinalDefinitionInLinkageUnit =
+          Sym.getVisibility() != GlobalValue::DefaultVisibility;
+    }
+    Resolutions.push_back(Res);
+  }
+
+  if (Error Err = LTO.add(std::move(*FileOrErr), Resolutions)) {
+    LogS << "Error: " << toString(std::move(Err)) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+// Add the names of the symbols the relocatable Input references but does not
+// define to Names.
+static amd_comgr_status_t collectUndefinedSymbols(DataObject *Input,
+                                                  StringSet<> &Names,
+                                                  raw_ostream &LogS) {
+  auto ObjOrErr = object::ObjectFile::createObjectFile(
+      MemoryBufferRef(StringRef(Input->Data, Input->Size), Input->Name));
+  if (!ObjOrErr) {
+    LogS << "Error: " << toString(ObjOrErr.takeError()) << "\n";
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (const object::SymbolRef &Sym : (*ObjOrErr)->symbols()) {
+    Expected<uint32_t> FlagsOrErr = Sym.getFlags();
+    if (errorToBool(FlagsOrErr.takeError()) ||
+        !(*FlagsOrErr & object::SymbolRef::SF_Undefined)) {
+      continue;
+    }
+    Expected<StringRef> NameOrErr = Sym.getName();
+    if (errorToBool(NameOrErr.takeError())) {
+      continue;
+    }
+    Names.insert(*NameOrErr);
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 static void logArgv(raw_ostream &OS, StringRef ProgramName,
                     ArrayRef<const char *> Argv) {
   OS << "     Driver Job Args: " << ProgramName;
@@ -659,8 +952,17 @@ AMDGPUCompiler::executeInProcessDriver(ArrayRef<const char *> Args) {
   // errors that would be diagnosed here will also be diagnosed later, when the
   // DiagnosticsEngine actually exists.
   (void)ParseDiagnosticArgs(*DiagOpts, ArgList);
-  TextDiagnosticPrinter *DiagClient =
-      new TextDiagnosticPrinter(LogS, &*DiagOpts);
+  DiagnosticConsumer *DiagClient;
+  if (Diagnostics) {
+    std::unique_ptr<DiagnosticConsumer> TextClient;
+    if (shouldPrintDiagnostics()) {
+      TextClient = std::make_unique<TextDiagnosticPrinter>(LogS, &*DiagOpts);
+    }
+    DiagClient =
+        new DiagnosticRecorderConsumer(*Diagnostics, std::move(TextClient));
+  } else {
+    DiagClient = new TextDiagnosticPrinter(LogS, &*DiagOpts);
+  }
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs);
   DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
   ProcessWarningOptions(Diags, *DiagOpts, /*ReportDiags=*/false);
@@ -686,6 +988,7 @@ AMDGPUCompiler::executeInProcessDriver(ArrayRef<const char *> Args) {
                               : AMD_COMGR_STATUS_SUCCESS;
   }
   for (auto &Job : C->getJobs()) {
+    statistics::recordDriverJob(Job.getCreator().getName());
     auto Arguments = Job.getArguments();
     SmallVector<const char *, 128> Argv;
     initializeCommandLineArgs(Argv);
@@ -739,7 +1042,10 @@ AMDGPUCompiler::executeInProcessDriver(ArrayRef<const char *> Args) {
       if (auto Status = parseLLVMOptions(Asm.LLVMArgs)) {
         return Status;
       }
-      if (executeAssembler(Asm, Diags, LogS)) {
+      auto HandleDiag = [&](const SMDiagnostic &SMDiag) {
+        reportDiagnostic(SMDiag, "");
+      };
+      if (executeAssembler(Asm, Diags, HandleDiag)) {
         return AMD_COMGR_STATUS_ERROR;
       }
     } else if (Job.getCreator().getName() == LinkerJobName) {
@@ -757,7 +1063,8 @@ AMDGPUCompiler::executeInProcessDriver(ArrayRef<const char *> Args) {
 }
 
 amd_comgr_status_t AMDGPUCompiler::createTmpDirs() {
-  ProfilePoint Point("CreateDir");
+  static ProfilePointId CreateDirId("CreateDir");
+  ProfilePoint Point(CreateDirId);
   if (fs::createUniqueDirectory("comgr", TmpDir)) {
     return AMD_COMGR_STATUS_ERROR;
   }
@@ -827,7 +1134,8 @@ amd_comgr_status_t AMDGPUCompiler::removeTmpDirs() {
   if (TmpDir.empty()) {
     return AMD_COMGR_STATUS_SUCCESS;
   }
-  ProfilePoint Point("RemoveDir");
+  static ProfilePointId RemoveDirId("RemoveDir");
+  ProfilePoint Point(RemoveDirId);
 #ifndef _WIN32
   if (fs::remove_directories(TmpDir)) {
     return AMD_COMGR_STATUS_ERROR;
@@ -876,19 +1184,22 @@ amd_comgr_status_t AMDGPUCompiler::executeOutOfProcessHIPCompilation(
   return RC ? AMD_COMGR_STATUS_ERROR : AMD_COMGR_STATUS_SUCCESS;
 }
 
-amd_comgr_status_t AMDGPUCompiler::processFile(const char *InputFilePath,
-                                               const char *OutputFilePath) {
+amd_comgr_status_t
+AMDGPUCompiler::processFile(const char *InputFilePath,
+                            const char *OutputFilePath,
+                            ArrayRef<const char *> InputArgs) {
   SmallVector<const char *, 128> Argv;
 
   for (auto &Arg : Args) {
     Argv.push_back(Arg);
   }
 
+  if (ActionInfo->getOptionSummary().ROCmPath) {
+    NoGpuLib = false;
+  }
+
   for (auto &Option : ActionInfo->getOptions()) {
     Argv.push_back(Option.c_str());
-    if (Option.rfind("--rocm-path", 0) == 0) {
-      NoGpuLib = false;
-    }
   }
 
   // The ROCm device library should be provided via --rocm-path. Otherwise
@@ -902,6 +1213,7 @@ amd_comgr_status_t AMDGPUCompiler::processFile(const char *InputFilePath,
     Argv.push_back(strdup(save_tmps.c_str()));
   }
 
+  Argv.append(InputArgs.begin(), InputArgs.end());
   Argv.push_back(InputFilePath);
 
   Argv.push_back("-o");
@@ -937,7 +1249,15 @@ AMDGPUCompiler::processFiles(amd_comgr_data_kind_t OutputKind,
     }
 
     auto InputFilePath = getFilePath(Input, InputDir);
-    if (auto Status = outputToFile(Input, InputFilePath)) {
+    // Unused kernels are not eliminated here, as functions called from other
+    // translation units are only known once they are linked.
+    if (Input->DataKind == AMD_COMGR_DATA_KIND_BC &&
+        !ActionInfo->FunctionOrder.empty()) {
+      if (auto Status = outputOrderedBitcodeToFile(
+              Input, InputFilePath, ActionInfo->FunctionOrder, LogS)) {
+        return Status;
+      }
+    } else if (auto Status = outputToFile(Input, InputFilePath)) {
       return Status;
     }
 
@@ -952,8 +1272,13 @@ AMDGPUCompiler::processFiles(amd_comgr_data_kind_t OutputKind,
 
     auto OutputFilePath = getFilePath(Output, OutputDir);
 
-    if (auto Status =
-            processFile(InputFilePath.c_str(), OutputFilePath.c_str())) {
+    SmallVector<const char *, 1> InputArgs;
+    if (AddCompilationUnitID && Input->DataKind == AMD_COMGR_DATA_KIND_SOURCE) {
+      InputArgs.push_back(getCompilationUnitIDOption(Input));
+    }
+
+    if (auto Status = processFile(InputFilePath.c_str(),
+                                  OutputFilePath.c_str(), InputArgs)) {
       return Status;
     }
 
@@ -969,6 +1294,27 @@ AMDGPUCompiler::processFiles(amd_comgr_data_kind_t OutputKind,
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+// Clang derives the default compilation unit ID from the input path, which is
+// a fresh temporary file for every action. Derive it from the source and the
+// options instead, so that recompiling a translation unit yields identical
+// bitcode while distinct translation units still get distinct IDs for the
+// externalized static device variables of a relocatable device code link.
+const char *AMDGPUCompiler::getCompilationUnitIDOption(DataObject *Input) {
+  MD5 Hash;
+  Hash.update(Input->Name);
+  Hash.update(StringRef(Input->Data, Input->Size));
+  if (ActionInfo->IsaName) {
+    Hash.update(ActionInfo->IsaName);
+  }
+  for (auto &Option : ActionInfo->getOptions()) {
+    Hash.update(Option);
+  }
+  MD5::MD5Result Result;
+  Hash.final(Result);
+
+  return Saver.save(Twine("-cuid=") + utohexstr(Result.low(), true)).data();
+}
+
 amd_comgr_status_t AMDGPUCompiler::addIncludeFlags() {
   if (ActionInfo->Path) {
     Args.push_back("-I");
@@ -1046,12 +1392,20 @@ amd_comgr_status_t AMDGPUCompiler::addCompilationFlags() {
     Args.push_back("-std=cl2.0");
     Args.push_back("-cl-no-stdinc");
     break;
-  case AMD_COMGR_LANGUAGE_HIP:
+  case AMD_COMGR_LANGUAGE_HIP: {
+    auto Summary = ActionInfo->getOptionSummary();
     Args.push_back("hip");
-    Args.push_back("-std=c++11");
+    if (!Summary.LanguageStandard) {
+      Args.push_back("-std=c++11");
+    }
     Args.push_back("-target");
     Args.push_back("x86_64-unknown-linux-gnu");
     Args.push_back("--cuda-device-only");
+    // With -fgpu-rdc each source is compiled to bitcode which may reference
+    // device functions and variables of other translation units. These are
+    // resolved by AMD_COMGR_ACTION_LINK_BC_TO_BC before code generation.
+    AddCompilationUnitID =
+        Summary.GPURelocatableDeviceCode && !Summary.CompilationUnitID;
     Args.push_back("-isystem");
     Args.push_back(ROCMIncludePath.c_str());
     Args.push_back("-isystem");
@@ -1061,6 +1415,7 @@ amd_comgr_status_t AMDGPUCompiler::addCompilationFlags() {
     Args.push_back("-isystem");
     Args.push_back(ClangIncludePath2.c_str());
     break;
+  }
   default:
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
@@ -1208,7 +1563,7 @@ amd_comgr_status_t AMDGPUCompiler::linkBitcodeToBitcode() {
           SMDiag, Context, true);
 
       if (!Mod) {
-        SMDiag.print(Input->Name, LogS, /* ShowColors */ false);
+        reportDiagnostic(SMDiag, Input->Name);
         return AMD_COMGR_STATUS_ERROR;
       }
       if (verifyModule(*Mod, &LogS))
@@ -1302,7 +1657,7 @@ amd_comgr_status_t AMDGPUCompiler::linkBitcodeToBitcode() {
           SMDiag, Context, true);
 
       if (!Mod) {
-        SMDiag.print(Result->Name, LogS, /* ShowColors */ false);
+        reportDiagnostic(SMDiag, Result->Name);
         return AMD_COMGR_STATUS_ERROR;
       }
       if (verifyModule(*Mod, &LogS))
@@ -1437,7 +1792,7 @@ amd_comgr_status_t AMDGPUCompiler::linkBitcodeToBitcode() {
                           SMDiag, Context, true);
 
         if (!Mod) {
-          SMDiag.print(ChildName.c_str(), LogS, /* ShowColors */ false);
+          reportDiagnostic(SMDiag, ChildName.c_str());
           return AMD_COMGR_STATUS_ERROR;
         }
         if (verifyModule(*Mod, &LogS))
@@ -1459,6 +1814,10 @@ amd_comgr_status_t AMDGPUCompiler::linkBitcodeToBitcode() {
     return AMD_COMGR_STATUS_ERROR;
   }
 
+  if (!ActionInfo->KernelRoots.empty()) {
+    eliminateUnusedKernels(*Composite, ActionInfo->KernelRoots);
+  }
+
   SmallString<0> OutBuf;
   BitcodeWriter Writer(OutBuf);
   Writer.writeModule(*Composite, false, nullptr, false, nullptr);
@@ -1542,6 +1901,19 @@ amd_comgr_status_t AMDGPUCompiler::linkToRelocatable() {
     Args.push_back(Option.c_str());
   }
 
+  // The output of a relocatable link is expected to be linked again, so
+  // splitting is left to that final link.
+  switch (ActionInfo->DebugInfoMode) {
+  case AMD_COMGR_DEBUG_INFO_MODE_STRIP:
+    Args.push_back("--strip-debug");
+    break;
+  case AMD_COMGR_DEBUG_INFO_MODE_COMPRESS:
+    Args.push_back(getCompressDebugSectionsOption());
+    break;
+  default:
+    break;
+  }
+
   SmallVector<SmallString<128>, 128> Inputs;
   for (auto *Input : InSet->DataObjects) {
     if (Input->DataKind != AMD_COMGR_DATA_KIND_RELOCATABLE) {
@@ -1581,11 +1953,141 @@ amd_comgr_status_t AMDGPUCompiler::linkToRelocatable() {
   return amd_comgr_data_set_add(OutSetT, OutputT);
 }
 
+amd_comgr_status_t
+AMDGPUCompiler::thinLinkBitcode(std::vector<std::string> &Objects) {
+  static ProfilePointId ThinLTOId("ThinLTO");
+  ProfilePoint Point(ThinLTOId);
+
+  if (!ActionInfo->IsaName) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  TargetIdentifier Ident;
+  if (auto Status = parseTargetIdentifier(ActionInfo->IsaName, Ident)) {
+    return Status;
+  }
+
+  lto::Config Conf;
+  Conf.CPU = Ident.Processor.str();
+  // Target ID features are spelled "xnack+", subtarget features "+xnack".
+  for (StringRef Feature : Ident.Features) {
+    Conf.MAttrs.push_back((Twine(Feature.back()) + Feature.drop_back()).str());
+  }
+  Conf.RelocModel = Reloc::PIC_;
+  // Give each function a section of its own, so that the linker can lay them
+  // out in the requested order across partitions.
+  Conf.Options.FunctionSections = !ActionInfo->FunctionOrder.empty();
+
+  // The backends of different modules report diagnostics concurrently.
+  std::mutex DiagMutex;
+  Conf.DiagHandler = [this, &DiagMutex](const DiagnosticInfo &DI) {
+    std::lock_guard<std::mutex> Lock(DiagMutex);
+    AMDGPUCompilerDiagnosticHandler(this).handleDiagnostics(DI);
+  };
+
+  // Use as many threads as lld would for the same -Wl,--thinlto-jobs option.
+  ThreadPoolStrategy Strategy = heavyweight_hardware_concurrency();
+  for (auto &Option : ActionInfo->getOptions()) {
+    StringRef Jobs(Option);
+    if (!Jobs.consume_front("-Wl,--thinlto-jobs=")) {
+      continue;
+    }
+    auto JobsStrategy = get_threadpool_strategy(Jobs);
+    if (!JobsStrategy) {
+      LogS << "Error: invalid ThinLTO job count: " << Jobs << "\n";
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Strategy = *JobsStrategy;
+  }
+
+  lto::LTO LTO(std::move(Conf), lto::createInProcessThinBackend(Strategy));
+
+  StringSet<> Roots;
+  for (auto &Root : ActionInfo->KernelRoots) {
+    Roots.insert(Root);
+  }
+
+  // The relocatable inputs are linked with the output of LTO, so whatever
+  // they reference must survive it.
+  StringSet<> ObjectRefs;
+  for (auto *Input : InSet->DataObjects) {
+    if (Input->DataKind != AMD_COMGR_DATA_KIND_RELOCATABLE) {
+      continue;
+    }
+    if (auto Status = collectUndefinedSymbols(Input, ObjectRefs, LogS)) {
+      return Status;
+    }
+  }
+
+  StringSet<> Defined;
+  std::list<SmallString<0>> Buffers;
+  for (auto *Input : InSet->DataObjects) {
+    if (Input->DataKind != AMD_COMGR_DATA_KIND_BC) {
+      continue;
+    }
+
+    if (env::shouldSaveTemps()) {
+      if (auto Status = outputToFile(Input, getFilePath(Input, InputDir))) {
+        return Status;
+      }
+    }
+
+    if (auto Status = addThinLTOInput(LTO, Input, Roots, ObjectRefs, Defined,
+                                      Buffers, LogS)) {
+      return Status;
+    }
+  }
+
+  // Each task optimizes and generates code for one module, in parallel.
+  std::vector<SmallString<0>> Outputs(LTO.getMaxTasks());
+  auto AddStream = [&Outputs](unsigned Task, const Twine &ModuleName)
+      -> Expected<std::unique_ptr<CachedFileStream>> {
+    return std::make_unique<CachedFileStream>(
+        std::make_unique<raw_svector_ostream>(Outputs[Task]));
+  };
+  if (Error Err = LTO.run(AddStream)) {
+    LogS << "Error: " << toString(std::move(Err)) << "\n";
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  for (size_t I = 0; I < Outputs.size(); ++I) {
+    if (Outputs[I].empty()) {
+      continue;
+    }
+    SmallString<128> Path = InputDir;
+    path::append(Path, "thinlto-" + Twine(I) + ".o");
+    if (auto Status = outputToFile(Outputs[I], Path)) {
+      return Status;
+    }
+    Objects.push_back(std::string(Path));
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t AMDGPUCompiler::linkToExecutable() {
   if (auto Status = createTmpDirs()) {
     return Status;
   }
 
+  return linkObjectsToExecutable({});
+}
+
+amd_comgr_status_t AMDGPUCompiler::linkBitcodeToExecutable() {
+  if (auto Status = createTmpDirs()) {
+    return Status;
+  }
+
+  std::vector<std::string> Objects;
+  if (auto Status = thinLinkBitcode(Objects)) {
+    return Status;
+  }
+
+  return linkObjectsToExecutable(Objects);
+}
+
+amd_comgr_status_t
+AMDGPUCompiler::linkObjectsToExecutable(ArrayRef<std::string> Objects) {
   if (ActionInfo->IsaName) {
     if (auto Status = addTargetIdentifierFlags(ActionInfo->IsaName)) {
       return Status;
@@ -1596,6 +2098,46 @@ amd_comgr_status_t AMDGPUCompiler::linkToExecutable() {
     Args.push_back(Option.c_str());
   }
 
+  std::string CompressOption =
+      std::string("-Wl,") + getCompressDebugSectionsOption();
+  switch (ActionInfo->DebugInfoMode) {
+  case AMD_COMGR_DEBUG_INFO_MODE_STRIP:
+    Args.push_back("-Wl,--strip-debug");
+    break;
+  case AMD_COMGR_DEBUG_INFO_MODE_COMPRESS:
+    Args.push_back(CompressOption.c_str());
+    break;
+  default:
+    break;
+  }
+
+  // Unused kernels are only removed from bitcode linked as a whole, as the
+  // metadata of a relocatable refers to all of its kernels, but whatever
+  // becomes unreferenced through other means can still be dropped here.
+  if (!ActionInfo->KernelRoots.empty()) {
+    Args.push_back("-Wl,--gc-sections");
+  }
+
+  // Lay out the input sections defining the listed functions first. Code
+  // generated from bitcode in this action uses a section per function, other
+  // relocatables are placed as a whole.
+  if (!ActionInfo->FunctionOrder.empty()) {
+    SmallString<128> OrderFilePath = TmpDir;
+    path::append(OrderFilePath, "function-order.txt");
+    std::string Order;
+    for (auto &Name : ActionInfo->FunctionOrder) {
+      Order += Name;
+      Order += '\n';
+    }
+    if (auto Status = outputToFile(Order, OrderFilePath)) {
+      return Status;
+    }
+    Args.push_back(
+        Saver.save(Twine("-Wl,--symbol-ordering-file=") + OrderFilePath)
+            .data());
+    Args.push_back("-Wl,--no-warn-symbol-ordering");
+  }
+
   SmallVector<SmallString<128>, 128> Inputs;
   for (auto *Input : InSet->DataObjects) {
     if (Input->DataKind != AMD_COMGR_DATA_KIND_RELOCATABLE) {
@@ -1608,6 +2150,9 @@ amd_comgr_status_t AMDGPUCompiler::linkToExecutable() {
     }
     Args.push_back(Inputs.back().c_str());
   }
+  for (auto &Object : Objects) {
+    Args.push_back(Object.c_str());
+  }
 
   amd_comgr_data_t OutputT;
   if (auto Status =
@@ -1630,6 +2175,28 @@ amd_comgr_status_t AMDGPUCompiler::linkToExecutable() {
     return Status;
   }
 
+  if (ActionInfo->DebugInfoMode == AMD_COMGR_DEBUG_INFO_MODE_SPLIT) {
+    amd_comgr_data_t DebugInfoT;
+    if (auto Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_DEBUG_INFO,
+                                            &DebugInfoT)) {
+      return Status;
+    }
+    ScopedDataObjectReleaser SDORDebugInfo(DebugInfoT);
+
+    DataObject *DebugInfo = DataObject::convert(DebugInfoT);
+    if (auto Status = DebugInfo->setName("a.so.debug")) {
+      return Status;
+    }
+
+    if (auto Status = splitDebugInfo(Output, DebugInfo, LogS)) {
+      return Status;
+    }
+
+    if (auto Status = amd_comgr_data_set_add(OutSetT, DebugInfoT)) {
+      return Status;
+    }
+  }
+
   return amd_comgr_data_set_add(OutSetT, OutputT);
 }
 
@@ -1638,6 +2205,31 @@ AMDGPUCompiler::AMDGPUCompiler(DataAction *ActionInfo, DataSet *InSet,
     : ActionInfo(ActionInfo), InSet(InSet), OutSetT(DataSet::convert(OutSet)),
       LogS(LogS) {
   initializeCommandLineArgs(Args);
+  if (ActionInfo->StructuredDiagnostics) {
+    Diagnostics = std::make_unique<DiagnosticRecorder>();
+  }
+}
+
+bool AMDGPUCompiler::shouldPrintDiagnostics() const {
+  return !Diagnostics || ActionInfo->Logging || env::shouldEmitVerboseLogs() ||
+         env::getRedirectLogs();
+}
+
+void AMDGPUCompiler::reportDiagnostic(const SMDiagnostic &SMDiag,
+                                      const char *ProgName) {
+  if (Diagnostics) {
+    Diagnostics->addSMDiagnostic(SMDiag);
+  }
+  if (shouldPrintDiagnostics()) {
+    SMDiag.print(ProgName, LogS, /* ShowColors */ false);
+  }
+}
+
+amd_comgr_status_t AMDGPUCompiler::addDiagnostics() {
+  if (!Diagnostics) {
+    return AMD_COMGR_STATUS_SUCCESS;
+  }
+  return Diagnostics->addToDataSet(OutSetT);
 }
 
 AMDGPUCompiler::~AMDGPUCompiler() {
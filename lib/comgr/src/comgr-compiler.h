@@ -39,6 +39,7 @@
 #ifndef COMGR_COMPILER_H
 #define COMGR_COMPILER_H
 
+#include "comgr-diagnostics.h"
 #include "comgr.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
@@ -60,6 +61,12 @@ class AMDGPUCompiler {
 
     bool handleDiagnostics(const llvm::DiagnosticInfo &DI) override {
       assert(Compiler && "Compiler cannot be nullptr");
+      if (Compiler->Diagnostics) {
+        Compiler->Diagnostics->addLLVMDiagnostic(DI);
+      }
+      if (!Compiler->shouldPrintDiagnostics()) {
+        return true;
+      }
       unsigned Severity = DI.getSeverity();
       switch (Severity) {
       case llvm::DS_Error:
@@ -117,11 +124,26 @@ class AMDGPUCompiler {
   llvm::StringSaver Saver = Allocator;
   /// Whether we need to disable Clang's device-lib linking.
   bool NoGpuLib = true;
+  /// Whether HIP sources are compiled as relocatable device code without a
+  /// user supplied compilation unit ID, and so need one derived per source.
+  bool AddCompilationUnitID = false;
+  /// Structured diagnostics of the action, if requested.
+  std::unique_ptr<DiagnosticRecorder> Diagnostics;
+
+  /// Whether diagnostics are printed to the log. Printing is skipped when
+  /// diagnostics are recorded and the log is neither returned nor redirected.
+  bool shouldPrintDiagnostics() const;
+  /// Record and print a diagnostic reported through a SourceMgr.
+  void reportDiagnostic(const llvm::SMDiagnostic &SMDiag,
+                        const char *ProgName);
 
   amd_comgr_status_t createTmpDirs();
   amd_comgr_status_t removeTmpDirs();
   amd_comgr_status_t processFile(const char *InputFilePath,
-                                 const char *OutputFilePath);
+                                 const char *OutputFilePath,
+                                 llvm::ArrayRef<const char *> InputArgs = {});
+  /// Return a -cuid option for @p Input which is stable across actions.
+  const char *getCompilationUnitIDOption(DataObject *Input);
   /// Process each file in @c InSet individually, placing output in @c OutSet.
   amd_comgr_status_t processFiles(amd_comgr_data_kind_t OutputKind,
                                   const char *OutputSuffix);
@@ -134,6 +156,14 @@ class AMDGPUCompiler {
 
   amd_comgr_status_t executeInProcessDriver(llvm::ArrayRef<const char *> Args);
 
+  /// Optimize and generate code for the bitcode in @c InSet with ThinLTO,
+  /// writing one relocatable per partition and appending its path to
+  /// @p Objects.
+  amd_comgr_status_t thinLinkBitcode(std::vector<std::string> &Objects);
+  /// Link the relocatables in @c InSet and @p Objects into an executable.
+  amd_comgr_status_t
+  linkObjectsToExecutable(llvm::ArrayRef<std::string> Objects);
+
 public:
   AMDGPUCompiler(DataAction *ActionInfo, DataSet *InSet, DataSet *OutSet,
                  llvm::raw_ostream &LogS);
@@ -147,8 +177,13 @@ public:
   amd_comgr_status_t assembleToRelocatable();
   amd_comgr_status_t linkToRelocatable();
   amd_comgr_status_t linkToExecutable();
+  amd_comgr_status_t linkBitcodeToExecutable();
   amd_comgr_status_t compileToFatBin();
 
+  /// Add the structured diagnostics of the action, if requested, to the
+  /// result set.
+  amd_comgr_status_t addDiagnostics();
+
   amd_comgr_language_t getLanguage() const { return ActionInfo->Language; }
 };
 } // namespace COMGR
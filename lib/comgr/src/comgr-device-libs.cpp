@@ -83,6 +83,60 @@ amd_comgr_status_t addPrecompiledHeaders(DataAction *ActionInfo,
   }
 }
 
+static void prefetch(StringRef Data) {
+  // One read per page is enough to fault it in.
+  constexpr size_t PageSize = 4096;
+  volatile char Sink;
+  for (size_t I = 0; I < Data.size(); I += PageSize) {
+    Sink = Data[I];
+  }
+  (void)Sink;
+}
+
+void prefetchDeviceLibraries(amd_comgr_language_t Language) {
+  switch (Language) {
+  case AMD_COMGR_LANGUAGE_OPENCL_1_2:
+    prefetch(StringRef(reinterpret_cast<const char *>(opencl1_2_c),
+                       opencl1_2_c_size));
+    break;
+  case AMD_COMGR_LANGUAGE_OPENCL_2_0:
+    prefetch(StringRef(reinterpret_cast<const char *>(opencl2_0_c),
+                       opencl2_0_c_size));
+    break;
+  case AMD_COMGR_LANGUAGE_HIP:
+    break;
+  default:
+    return;
+  }
+
+  for (auto DeviceLib : getDeviceLibraries()) {
+    prefetch(std::get<1>(DeviceLib));
+  }
+}
+
+amd_comgr_status_t parseDeviceLibraryOptions(ArrayRef<std::string> Options,
+                                             unsigned &Flags) {
+  Flags = 0;
+  for (auto &Option : Options) {
+    unsigned Flag = StringSwitch<unsigned>(Option)
+                        .Case("correctly_rounded_sqrt",
+                              DeviceLibCorrectlyRoundedSqrt)
+                        .Case("daz_opt", DeviceLibDazOpt)
+                        .Case("finite_only", DeviceLibFiniteOnly)
+                        .Case("unsafe_math", DeviceLibUnsafeMath)
+                        .Case("wavefrontsize64", DeviceLibWavefrontsize64)
+                        .Case("code_object_v4", DeviceLibCodeObjectV4)
+                        .Case("code_object_v5", DeviceLibCodeObjectV5)
+                        .Default(0);
+    // It is invalid to provide an unknown option and to repeat an option.
+    if (!Flag || (Flags & Flag)) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Flags |= Flag;
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t addDeviceLibraries(DataAction *ActionInfo,
                                       DataSet *ResultSet) {
   if (ActionInfo->Language != AMD_COMGR_LANGUAGE_OPENCL_1_2 &&
@@ -128,27 +182,19 @@ amd_comgr_status_t addDeviceLibraries(DataAction *ActionInfo,
     return Status;
   }
 
-  bool CorrectlyRoundedSqrt = false, DazOpt = false, FiniteOnly = false,
-       UnsafeMath = false, Wavefrontsize64 = false;
+  unsigned Flags;
+  if (auto Status = ActionInfo->getDeviceLibraryFlags(Flags)) {
+    return Status;
+  }
+  bool CorrectlyRoundedSqrt = Flags & DeviceLibCorrectlyRoundedSqrt;
+  bool DazOpt = Flags & DeviceLibDazOpt;
+  bool FiniteOnly = Flags & DeviceLibFiniteOnly;
+  bool UnsafeMath = Flags & DeviceLibUnsafeMath;
+  bool Wavefrontsize64 = Flags & DeviceLibWavefrontsize64;
   // TODO: Instead of a boolean CodeObjectV5 option, we should have an integer
   // CodeObjectV=N option, where N is the intended version.
-  bool CodeObjectV4 = false, CodeObjectV5 = false;
-  for (auto &Option : ActionInfo->getOptions(true)) {
-    bool *Flag = StringSwitch<bool *>(Option)
-                     .Case("correctly_rounded_sqrt", &CorrectlyRoundedSqrt)
-                     .Case("daz_opt", &DazOpt)
-                     .Case("finite_only", &FiniteOnly)
-                     .Case("unsafe_math", &UnsafeMath)
-                     .Case("wavefrontsize64", &Wavefrontsize64)
-                     .Case("code_object_v4", &CodeObjectV4)
-                     .Case("code_object_v5", &CodeObjectV5)
-                     .Default(nullptr);
-    // It is invalid to provide an unknown option and to repeat an option.
-    if (!Flag || *Flag) {
-      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
-    }
-    *Flag = true;
-  }
+  bool CodeObjectV4 = Flags & DeviceLibCodeObjectV4;
+  bool CodeObjectV5 = Flags & DeviceLibCodeObjectV5;
 
   if (auto Status = addOCLCObject(
           ResultSet, get_oclc_correctly_rounded_sqrt(CorrectlyRoundedSqrt))) {
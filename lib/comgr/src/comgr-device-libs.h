@@ -39,6 +39,7 @@
 #include "amd_comgr.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include <string>
 #include <tuple>
 
 namespace COMGR {
@@ -52,9 +53,31 @@ amd_comgr_status_t addPrecompiledHeaders(DataAction *ActionInfo,
 amd_comgr_status_t addDeviceLibraries(DataAction *ActionInfo,
                                       DataSet *ResultSet);
 
+/// Options accepted by AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES.
+enum DeviceLibraryFlag : unsigned {
+  DeviceLibCorrectlyRoundedSqrt = 1 << 0,
+  DeviceLibDazOpt = 1 << 1,
+  DeviceLibFiniteOnly = 1 << 2,
+  DeviceLibUnsafeMath = 1 << 3,
+  DeviceLibWavefrontsize64 = 1 << 4,
+  DeviceLibCodeObjectV4 = 1 << 5,
+  DeviceLibCodeObjectV5 = 1 << 6,
+};
+
+/// Parse the device library options in \p Options into a bitmask of
+/// DeviceLibraryFlag. It is invalid to provide an unknown option and to repeat
+/// an option.
+amd_comgr_status_t
+parseDeviceLibraryOptions(llvm::ArrayRef<std::string> Options,
+                          unsigned &Flags);
+
 llvm::ArrayRef<std::tuple<llvm::StringRef, llvm::StringRef>>
 getDeviceLibraries();
 
+/// Read the embedded precompiled header and device libraries used to compile
+/// \p Language, so their pages are resident before the first compilation.
+void prefetchDeviceLibraries(amd_comgr_language_t Language);
+
 } // namespace COMGR
 
 #endif // COMGR_DEVICE_LIBS_H
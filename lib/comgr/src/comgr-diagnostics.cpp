@@ -0,0 +1,259 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-diagnostics.h"
+#include "comgr.h"
+#include "clang/Basic/DiagnosticIDs.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace COMGR {
+
+static StringRef getSeverityName(DiagnosticsEngine::Level Level) {
+  switch (Level) {
+  case DiagnosticsEngine::Ignored:
+    return "ignored";
+  case DiagnosticsEngine::Note:
+    return "note";
+  case DiagnosticsEngine::Remark:
+    return "remark";
+  case DiagnosticsEngine::Warning:
+    return "warning";
+  case DiagnosticsEngine::Error:
+    return "error";
+  case DiagnosticsEngine::Fatal:
+    return "fatal";
+  }
+  llvm_unreachable("invalid diagnostic level");
+}
+
+static StringRef getSeverityName(DiagnosticSeverity Severity) {
+  switch (Severity) {
+  case DS_Error:
+    return "error";
+  case DS_Warning:
+    return "warning";
+  case DS_Remark:
+    return "remark";
+  case DS_Note:
+    return "note";
+  }
+  llvm_unreachable("invalid diagnostic severity");
+}
+
+static StringRef getSeverityName(SourceMgr::DiagKind Kind) {
+  switch (Kind) {
+  case SourceMgr::DK_Error:
+    return "error";
+  case SourceMgr::DK_Warning:
+    return "warning";
+  case SourceMgr::DK_Remark:
+    return "remark";
+  case SourceMgr::DK_Note:
+    return "note";
+  }
+  llvm_unreachable("invalid diagnostic kind");
+}
+
+DiagnosticRecorder::DiagnosticRecorder() {
+  Doc.getRoot().getArray(/*Convert=*/true);
+}
+
+msgpack::MapDocNode DiagnosticRecorder::addDiagnostic(StringRef Severity,
+                                                      StringRef Message) {
+  auto Diag = Doc.getMapNode();
+  Diag["severity"] = Severity;
+  Diag["message"] = Doc.getNode(Message, /*Copy=*/true);
+  Doc.getRoot().getArray().push_back(Diag);
+  return Diag;
+}
+
+void DiagnosticRecorder::addClangDiagnostic(DiagnosticsEngine::Level Level,
+                                            const Diagnostic &Info,
+                                            const LangOptions *LangOpts) {
+  SmallString<128> Message;
+  Info.FormatDiagnostic(Message);
+  auto Diag = addDiagnostic(getSeverityName(Level), Message);
+  Diag["id"] = Info.getID();
+  StringRef Option = DiagnosticIDs::getWarningOptionForDiag(Info.getID());
+  if (!Option.empty()) {
+    Diag["option"] = Option;
+  }
+
+  if (!Info.hasSourceManager()) {
+    return;
+  }
+  const SourceManager &SM = Info.getSourceManager();
+  PresumedLoc Loc = SM.getPresumedLoc(Info.getLocation());
+  if (Loc.isValid()) {
+    Diag["file"] = Doc.getNode(StringRef(Loc.getFilename()), /*Copy=*/true);
+    Diag["line"] = Loc.getLine();
+    Diag["column"] = Loc.getColumn();
+  }
+
+  if (Info.getFixItHints().empty()) {
+    return;
+  }
+  auto FixIts = Doc.getArrayNode();
+  for (const FixItHint &Hint : Info.getFixItHints()) {
+    SourceLocation End = Hint.RemoveRange.getEnd();
+    // Token ranges end at the start of their last token, which can only be
+    // resolved to a character while the language options are known.
+    if (Hint.RemoveRange.isTokenRange() && LangOpts) {
+      End = Lexer::getLocForEndOfToken(End, 0, SM, *LangOpts);
+    }
+    PresumedLoc BeginLoc = SM.getPresumedLoc(Hint.RemoveRange.getBegin());
+    PresumedLoc EndLoc = SM.getPresumedLoc(End);
+    if (BeginLoc.isInvalid() || EndLoc.isInvalid()) {
+      continue;
+    }
+    auto FixIt = Doc.getMapNode();
+    FixIt["file"] = Doc.getNode(StringRef(BeginLoc.getFilename()),
+                                /*Copy=*/true);
+    FixIt["line"] = BeginLoc.getLine();
+    FixIt["column"] = BeginLoc.getColumn();
+    FixIt["end_line"] = EndLoc.getLine();
+    FixIt["end_column"] = EndLoc.getColumn();
+    FixIt["replacement"] = Doc.getNode(StringRef(Hint.CodeToInsert),
+                                       /*Copy=*/true);
+    FixIts.push_back(FixIt);
+  }
+  Diag["fixits"] = FixIts;
+}
+
+void DiagnosticRecorder::addLLVMDiagnostic(const DiagnosticInfo &DI) {
+  std::string Message;
+  raw_string_ostream OS(Message);
+  DiagnosticPrinterRawOStream DP(OS);
+  DI.print(DP);
+  OS.flush();
+  // LLVM diagnostics have no common way to query their location, which is
+  // part of the printed message instead.
+  addDiagnostic(getSeverityName(DI.getSeverity()), Message);
+}
+
+void DiagnosticRecorder::addSMDiagnostic(const SMDiagnostic &SMDiag) {
+  auto Diag = addDiagnostic(getSeverityName(SMDiag.getKind()),
+                            SMDiag.getMessage());
+  if (SMDiag.getLineNo() > 0) {
+    Diag["file"] = Doc.getNode(SMDiag.getFilename(), /*Copy=*/true);
+    Diag["line"] = SMDiag.getLineNo();
+    // SMDiagnostic columns count from zero, unlike the other diagnostics.
+    if (SMDiag.getColumnNo() >= 0) {
+      Diag["column"] = SMDiag.getColumnNo() + 1;
+    }
+  }
+
+  const SourceMgr *SM = SMDiag.getSourceMgr();
+  if (!SM || SMDiag.getFixIts().empty()) {
+    return;
+  }
+  auto FixIts = Doc.getArrayNode();
+  for (const SMFixIt &Hint : SMDiag.getFixIts()) {
+    auto Begin = SM->getLineAndColumn(Hint.getRange().Start);
+    auto End = SM->getLineAndColumn(Hint.getRange().End);
+    auto FixIt = Doc.getMapNode();
+    FixIt["file"] = Doc.getNode(SMDiag.getFilename(), /*Copy=*/true);
+    FixIt["line"] = Begin.first;
+    FixIt["column"] = Begin.second;
+    FixIt["end_line"] = End.first;
+    FixIt["end_column"] = End.second;
+    FixIt["replacement"] = Doc.getNode(Hint.getText(), /*Copy=*/true);
+    FixIts.push_back(FixIt);
+  }
+  Diag["fixits"] = FixIts;
+}
+
+amd_comgr_status_t
+DiagnosticRecorder::addToDataSet(amd_comgr_data_set_t ResultSet) {
+  std::string Blob;
+  Doc.writeToBlob(Blob);
+
+  amd_comgr_data_t DiagT;
+  if (auto Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_DIAGNOSTIC,
+                                          &DiagT)) {
+    return Status;
+  }
+  ScopedDataObjectReleaser SDOR(DiagT);
+  DataObject *Diag = DataObject::convert(DiagT);
+  if (auto Status = Diag->setName("comgr-diagnostics")) {
+    return Status;
+  }
+  if (auto Status = Diag->setData(Blob)) {
+    return Status;
+  }
+  return amd_comgr_data_set_add(ResultSet, DiagT);
+}
+
+void DiagnosticRecorderConsumer::BeginSourceFile(const LangOptions &LangOpts,
+                                                 const Preprocessor *PP) {
+  this->LangOpts = &LangOpts;
+  if (Next) {
+    Next->BeginSourceFile(LangOpts, PP);
+  }
+}
+
+void DiagnosticRecorderConsumer::EndSourceFile() {
+  LangOpts = nullptr;
+  if (Next) {
+    Next->EndSourceFile();
+  }
+}
+
+void DiagnosticRecorderConsumer::finish() {
+  if (Next) {
+    Next->finish();
+  }
+}
+
+void DiagnosticRecorderConsumer::HandleDiagnostic(
+    DiagnosticsEngine::Level Level, const Diagnostic &Info) {
+  // Keep the error and warning counts, which clang reports after the
+  // compilation.
+  DiagnosticConsumer::HandleDiagnostic(Level, Info);
+  Recorder.addClangDiagnostic(Level, Info, LangOpts);
+  if (Next) {
+    Next->HandleDiagnostic(Level, Info);
+  }
+}
+
+} // namespace COMGR
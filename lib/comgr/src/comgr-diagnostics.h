@@ -0,0 +1,97 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_DIAGNOSTICS_H
+#define COMGR_DIAGNOSTICS_H
+
+#include "amd_comgr.h"
+#include "clang/Basic/Diagnostic.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+class DiagnosticInfo;
+class SMDiagnostic;
+} // namespace llvm
+
+namespace COMGR {
+
+/// Records the diagnostics of an action as a MsgPack array, which is returned
+/// to the user as an AMD_COMGR_DATA_KIND_DIAGNOSTIC data object. See the
+/// documentation of that data kind for the layout of each diagnostic.
+class DiagnosticRecorder {
+  llvm::msgpack::Document Doc;
+
+  llvm::msgpack::MapDocNode addDiagnostic(llvm::StringRef Severity,
+                                          llvm::StringRef Message);
+
+public:
+  DiagnosticRecorder();
+
+  void addClangDiagnostic(clang::DiagnosticsEngine::Level Level,
+                          const clang::Diagnostic &Info,
+                          const clang::LangOptions *LangOpts);
+  void addLLVMDiagnostic(const llvm::DiagnosticInfo &DI);
+  void addSMDiagnostic(const llvm::SMDiagnostic &Diag);
+
+  /// Add the recorded diagnostics to \p ResultSet as a data object named
+  /// "comgr-diagnostics".
+  amd_comgr_status_t addToDataSet(amd_comgr_data_set_t ResultSet);
+};
+
+/// A clang DiagnosticConsumer recording every diagnostic, and forwarding it to
+/// an optional text consumer when the diagnostics are also logged.
+class DiagnosticRecorderConsumer : public clang::DiagnosticConsumer {
+  DiagnosticRecorder &Recorder;
+  std::unique_ptr<clang::DiagnosticConsumer> Next;
+  const clang::LangOptions *LangOpts = nullptr;
+
+public:
+  DiagnosticRecorderConsumer(DiagnosticRecorder &Recorder,
+                             std::unique_ptr<clang::DiagnosticConsumer> Next)
+      : Recorder(Recorder), Next(std::move(Next)) {}
+
+  void BeginSourceFile(const clang::LangOptions &LangOpts,
+                       const clang::Preprocessor *PP) override;
+  void EndSourceFile() override;
+  void finish() override;
+  void HandleDiagnostic(clang::DiagnosticsEngine::Level Level,
+                        const clang::Diagnostic &Info) override;
+};
+
+} // namespace COMGR
+
+#endif // COMGR_DIAGNOSTICS_H
@@ -63,6 +63,15 @@ bool needTimeStatistics() {
   return TimeStatistics && StringRef(TimeStatistics) != "0";
 }
 
+size_t getSymbolizerCacheSize() {
+  static char *CacheSize = getenv("AMD_COMGR_SYMBOLIZER_CACHE_SIZE");
+  unsigned long long MiB;
+  if (!CacheSize || getAsUnsignedInteger(CacheSize, 10, MiB)) {
+    MiB = 256;
+  }
+  return MiB << 20;
+}
+
 bool shouldEmitVerboseLogs() {
   static char *VerboseLogs = getenv("AMD_COMGR_EMIT_VERBOSE_LOGS");
   return VerboseLogs && StringRef(VerboseLogs) != "0";
@@ -54,6 +54,10 @@ bool shouldEmitVerboseLogs();
 /// Return whether the environment requests time statistics collection.
 bool needTimeStatistics();
 
+/// Return the limit, in bytes, on the size of the code objects whose debug
+/// information is cached by the symbolizer.
+size_t getSymbolizerCacheSize();
+
 /// If environment variable ROCM_PATH is set, return the environment varaible,
 /// otherwise return the default ROCM path.
 llvm::StringRef getROCMPath();
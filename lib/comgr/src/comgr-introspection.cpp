@@ -0,0 +1,176 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-introspection.h"
+#include "comgr-metadata.h"
+#include "comgr-symbol.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace llvm;
+
+namespace COMGR {
+
+static amd_comgr_status_t collectSymbol(amd_comgr_symbol_t Symbol,
+                                        void *UserData) {
+  auto *Result = static_cast<IntrospectionResult *>(UserData);
+  const SymbolContext *Sym = DataSymbol::convert(Symbol)->DataSym;
+
+  Result->SymbolNames.push_back(Sym->Name);
+  amd_comgr_introspection_symbol_t Info = {};
+  Info.type = Sym->Type;
+  Info.size = Sym->Size;
+  Info.value = Sym->Value;
+  Info.is_undefined = Sym->Undefined;
+  Result->Symbols.push_back(Info);
+
+  // Code object V2 kernels have their own symbol type, later versions are
+  // identified by their kernel descriptor.
+  StringRef Name(Sym->Name);
+  if (Sym->Undefined) {
+    return AMD_COMGR_STATUS_SUCCESS;
+  }
+  if (Sym->Type == AMD_COMGR_SYMBOL_TYPE_AMDGPU_HSA_KERNEL ||
+      (Sym->Type == AMD_COMGR_SYMBOL_TYPE_OBJECT && Name.consume_back(".kd"))) {
+    Result->KernelNames.push_back(Name.str());
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+// Compute the requested Facts of Result.Data. They are only stored in Result
+// once all of them have been computed, so a failure leaves Result empty.
+static amd_comgr_status_t introspect(IntrospectionResult &Result,
+                                     uint32_t Facts) {
+  DataObject *DataP = Result.Data;
+  IntrospectionResult Computed;
+  Computed.Data = DataP;
+  if (DataP->DataKind != AMD_COMGR_DATA_KIND_RELOCATABLE &&
+      DataP->DataKind != AMD_COMGR_DATA_KIND_EXECUTABLE) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (Facts & AMD_COMGR_INTROSPECTION_FACT_ISA_NAME) {
+    if (auto Status = metadata::getElfIsaName(DataP, Computed.IsaName)) {
+      return Status;
+    }
+  }
+
+  if (Facts & AMD_COMGR_INTROSPECTION_FACT_METADATA) {
+    std::unique_ptr<DataMeta> MetaP(new (std::nothrow) DataMeta());
+    MetaDocument *MetaDoc = new (std::nothrow) MetaDocument();
+    if (!MetaP || !MetaDoc) {
+      delete MetaDoc;
+      return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+    }
+    MetaP->MetaDoc.reset(MetaDoc);
+    MetaP->DocNode = MetaP->MetaDoc->Document.getRoot();
+    if (auto Status = metadata::getMetadataRoot(DataP, MetaP.get())) {
+      return Status;
+    }
+    Computed.Metadata = std::move(MetaP);
+  }
+
+  if (Facts & (AMD_COMGR_INTROSPECTION_FACT_SYMBOLS |
+               AMD_COMGR_INTROSPECTION_FACT_KERNELS)) {
+    SymbolHelper Helper;
+    if (auto Status = Helper.iterateTable(StringRef(DataP->Data, DataP->Size),
+                                          DataP->DataKind, collectSymbol,
+                                          &Computed)) {
+      return Status;
+    }
+    if (!(Facts & AMD_COMGR_INTROSPECTION_FACT_SYMBOLS)) {
+      Computed.SymbolNames.clear();
+      Computed.Symbols.clear();
+    }
+    if (!(Facts & AMD_COMGR_INTROSPECTION_FACT_KERNELS)) {
+      Computed.KernelNames.clear();
+    }
+  }
+
+  Result = std::move(Computed);
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t
+IntrospectionInfo::create(DataSet *Set, uint32_t Facts, size_t ThreadCount,
+                          amd_comgr_introspection_info_t *InfoT) {
+  std::unique_ptr<IntrospectionInfo> Info(new (std::nothrow)
+                                              IntrospectionInfo());
+  if (!Info) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  Info->Results.resize(Set->DataObjects.size());
+  for (size_t I = 0; I < Info->Results.size(); ++I) {
+    Info->Results[I].Data = Set->DataObjects[I];
+  }
+
+  // The objects are independent, so each thread takes the next unprocessed
+  // object until none are left.
+  if (!ThreadCount) {
+    ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ThreadCount = std::min(ThreadCount, Info->Results.size());
+
+  std::atomic<size_t> Next(0);
+  auto Worker = [&]() {
+    for (size_t I = Next++; I < Info->Results.size(); I = Next++) {
+      Info->Results[I].Status = introspect(Info->Results[I], Facts);
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (size_t I = 1; I < ThreadCount; ++I) {
+    Threads.emplace_back(Worker);
+  }
+  Worker();
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+
+  for (IntrospectionResult &Result : Info->Results) {
+    for (size_t I = 0; I < Result.Symbols.size(); ++I) {
+      Result.Symbols[I].name = Result.SymbolNames[I].c_str();
+    }
+    for (const std::string &Name : Result.KernelNames) {
+      Result.Kernels.push_back(Name.c_str());
+    }
+  }
+
+  *InfoT = IntrospectionInfo::convert(Info.release());
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace COMGR
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_INTROSPECTION_H
+#define COMGR_INTROSPECTION_H
+
+#include "comgr.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace COMGR {
+
+/// The facts computed for one data object of an introspection info object.
+struct IntrospectionResult {
+  DataObject *Data = nullptr;
+  amd_comgr_status_t Status = AMD_COMGR_STATUS_SUCCESS;
+  std::string IsaName;
+  std::unique_ptr<DataMeta> Metadata;
+  std::vector<std::string> SymbolNames;
+  std::vector<amd_comgr_introspection_symbol_t> Symbols;
+  std::vector<std::string> KernelNames;
+  std::vector<const char *> Kernels;
+};
+
+/// The facts computed for every data object of a data set, in parallel, when
+/// the object is created.
+struct IntrospectionInfo {
+  static amd_comgr_introspection_info_t convert(IntrospectionInfo *Info) {
+    amd_comgr_introspection_info_t Handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(Info))};
+    return Handle;
+  }
+
+  static IntrospectionInfo *convert(amd_comgr_introspection_info_t Info) {
+    return reinterpret_cast<IntrospectionInfo *>(Info.handle);
+  }
+
+  static amd_comgr_status_t create(DataSet *Set, uint32_t Facts,
+                                   size_t ThreadCount,
+                                   amd_comgr_introspection_info_t *InfoT);
+
+  std::vector<IntrospectionResult> Results;
+};
+
+} // namespace COMGR
+
+#endif // COMGR_INTROSPECTION_H
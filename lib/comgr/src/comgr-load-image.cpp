@@ -0,0 +1,257 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-load-image.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+using namespace llvm::object;
+using namespace llvm::support;
+
+namespace COMGR {
+namespace loadimage {
+
+namespace {
+struct Kernel {
+  StringRef Name;
+  uint64_t Descriptor;
+};
+} // namespace
+
+// Offset of kernel_code_entry_byte_offset in a kernel descriptor.
+static const uint64_t KernelCodeEntryOffset = 16;
+// Size of a kernel descriptor.
+static const uint64_t KernelDescriptorSize = 64;
+
+// Apply the relocations of the SHT_RELA section Sec to Segments, which holds
+// the virtual addresses [Begin, End) of ELF.
+static amd_comgr_status_t applyRelocations(const ELF64LEFile &ELF,
+                                           const ELF64LE::Shdr &Sec,
+                                           uint64_t LoadBase, uint64_t Begin,
+                                           uint64_t End, char *Segments) {
+  auto RelasOrErr = ELF.relas(Sec);
+  if (errorToBool(RelasOrErr.takeError())) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  auto SymTabOrErr = ELF.getSection(Sec.sh_link);
+  if (errorToBool(SymTabOrErr.takeError())) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (const ELF64LE::Rela &Rela : *RelasOrErr) {
+    uint32_t Type = Rela.getType(false);
+    if (Type == ELF::R_AMDGPU_NONE) {
+      continue;
+    }
+
+    auto SymOrErr = ELF.getRelocationSymbol(Rela, *SymTabOrErr);
+    if (errorToBool(SymOrErr.takeError())) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    const ELF64LE::Sym *Sym = *SymOrErr;
+
+    // Undefined weak symbols resolve to zero; any other undefined symbol
+    // would have to be provided by another code object.
+    uint64_t S = 0;
+    if (Sym && Sym->st_shndx != ELF::SHN_UNDEF) {
+      S = LoadBase + Sym->st_value - Begin;
+    } else if (Sym && Sym->getBinding() != ELF::STB_WEAK) {
+      return AMD_COMGR_STATUS_ERROR;
+    }
+    uint64_t A = Rela.r_addend;
+
+    uint64_t Value;
+    unsigned Width;
+    switch (Type) {
+    case ELF::R_AMDGPU_RELATIVE64:
+      Value = LoadBase - Begin + A;
+      Width = 8;
+      break;
+    case ELF::R_AMDGPU_ABS64:
+      Value = S + A;
+      Width = 8;
+      break;
+    case ELF::R_AMDGPU_ABS32:
+    case ELF::R_AMDGPU_ABS32_LO:
+      Value = Lo_32(S + A);
+      Width = 4;
+      break;
+    case ELF::R_AMDGPU_ABS32_HI:
+      Value = Hi_32(S + A);
+      Width = 4;
+      break;
+    default:
+      return AMD_COMGR_STATUS_ERROR;
+    }
+
+    if (Rela.r_offset < Begin || Rela.r_offset >= End ||
+        End - Rela.r_offset < Width) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    char *Target = Segments + (Rela.r_offset - Begin);
+    if (Width == 8) {
+      endian::write64le(Target, Value);
+    } else {
+      endian::write32le(Target, Value);
+    }
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t createLoadImage(DataObject *DataP, uint64_t LoadBase,
+                                   std::string &Image) {
+  auto ObjOrErr = ObjectFile::createELFObjectFile(
+      MemoryBufferRef(StringRef(DataP->Data, DataP->Size), ""));
+  if (errorToBool(ObjOrErr.takeError())) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  auto *Obj = dyn_cast<ELF64LEObjectFile>(ObjOrErr->get());
+  if (!Obj) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  const ELF64LEFile &ELF = Obj->getELFFile();
+
+  auto PhdrsOrErr = ELF.program_headers();
+  if (errorToBool(PhdrsOrErr.takeError())) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  // The image covers the virtual addresses of all PT_LOAD segments, with any
+  // gaps between them and the memory beyond their file contents zeroed.
+  uint64_t Begin = UINT64_MAX;
+  uint64_t End = 0;
+  uint64_t Align = 1;
+  for (const ELF64LE::Phdr &Phdr : *PhdrsOrErr) {
+    if (Phdr.p_type != ELF::PT_LOAD) {
+      continue;
+    }
+    if (Phdr.p_filesz > Phdr.p_memsz ||
+        Phdr.p_offset + Phdr.p_filesz > ELF.getBufSize() ||
+        (Phdr.p_align && !isPowerOf2_64(Phdr.p_align))) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Begin = std::min<uint64_t>(Begin, Phdr.p_vaddr);
+    End = std::max<uint64_t>(End, Phdr.p_vaddr + Phdr.p_memsz);
+    Align = std::max<uint64_t>(Align, Phdr.p_align);
+  }
+  if (Begin >= End) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::vector<Kernel> Kernels;
+  size_t NamesSize = 0;
+  for (const ELFSymbolRef &Sym : Obj->getDynamicSymbolIterators()) {
+    Expected<StringRef> NameOrErr = Sym.getName();
+    Expected<uint64_t> ValueOrErr = Sym.getValue();
+    if (errorToBool(NameOrErr.takeError()) ||
+        errorToBool(ValueOrErr.takeError())) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    StringRef Name = *NameOrErr;
+    if (Sym.getELFType() != ELF::STT_OBJECT || !Name.consume_back(".kd")) {
+      continue;
+    }
+    if (*ValueOrErr < Begin || *ValueOrErr >= End ||
+        End - *ValueOrErr < KernelDescriptorSize) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Kernels.push_back({Name, *ValueOrErr - Begin});
+    NamesSize += Name.size() + 1;
+  }
+
+  uint64_t KernelOffset = sizeof(amd_comgr_load_image_header_t);
+  uint64_t NameOffset =
+      KernelOffset + Kernels.size() * sizeof(amd_comgr_load_image_kernel_t);
+  uint64_t SegmentOffset = alignTo(NameOffset + NamesSize, Align);
+  Image.assign(SegmentOffset + (End - Begin), '\0');
+  char *Segments = &Image[SegmentOffset];
+
+  for (const ELF64LE::Phdr &Phdr : *PhdrsOrErr) {
+    if (Phdr.p_type == ELF::PT_LOAD) {
+      memcpy(Segments + (Phdr.p_vaddr - Begin), ELF.base() + Phdr.p_offset,
+             Phdr.p_filesz);
+    }
+  }
+
+  auto SectionsOrErr = ELF.sections();
+  if (errorToBool(SectionsOrErr.takeError())) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  for (const ELF64LE::Shdr &Sec : *SectionsOrErr) {
+    if (Sec.sh_type != ELF::SHT_RELA || !(Sec.sh_flags & ELF::SHF_ALLOC)) {
+      continue;
+    }
+    if (auto Status =
+            applyRelocations(ELF, Sec, LoadBase, Begin, End, Segments)) {
+      return Status;
+    }
+  }
+
+  amd_comgr_load_image_header_t Header = {};
+  Header.magic = AMD_COMGR_LOAD_IMAGE_MAGIC;
+  Header.version = AMD_COMGR_LOAD_IMAGE_VERSION;
+  Header.load_base = LoadBase;
+  Header.segment_offset = SegmentOffset;
+  Header.segment_size = End - Begin;
+  Header.segment_align = Align;
+  Header.kernel_count = Kernels.size();
+  Header.kernel_offset = KernelOffset;
+  memcpy(&Image[0], &Header, sizeof(Header));
+
+  for (size_t I = 0; I < Kernels.size(); ++I) {
+    // The kernel descriptor is not relocated, so its entry offset can be
+    // read from the image.
+    int64_t EntryOffset = endian::read64le(
+        Segments + Kernels[I].Descriptor + KernelCodeEntryOffset);
+
+    amd_comgr_load_image_kernel_t Entry = {};
+    Entry.descriptor_offset = Kernels[I].Descriptor;
+    Entry.entry_offset = Kernels[I].Descriptor + EntryOffset;
+    Entry.name_offset = NameOffset;
+    memcpy(&Image[KernelOffset + I * sizeof(Entry)], &Entry, sizeof(Entry));
+
+    memcpy(&Image[NameOffset], Kernels[I].Name.data(), Kernels[I].Name.size());
+    NameOffset += Kernels[I].Name.size() + 1;
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace loadimage
+} // namespace COMGR
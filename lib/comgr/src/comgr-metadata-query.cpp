@@ -0,0 +1,240 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-metadata-query.h"
+#include "llvm/ADT/StringExtras.h"
+
+using namespace llvm;
+
+namespace COMGR {
+
+namespace {
+
+// Parse a string literal at the start of Path, which may escape '"' and '\'
+// with a backslash.
+bool parseString(StringRef &Path, std::string &String) {
+  if (!Path.consume_front("\"")) {
+    return false;
+  }
+  String.clear();
+  while (!Path.empty()) {
+    char C = Path.front();
+    Path = Path.drop_front();
+    if (C == '"') {
+      return true;
+    }
+    if (C == '\\') {
+      if (Path.empty()) {
+        return false;
+      }
+      C = Path.front();
+      Path = Path.drop_front();
+    }
+    String.push_back(C);
+  }
+  return false;
+}
+
+bool findKey(msgpack::DocNode Node, StringRef Key, msgpack::DocNode &Value) {
+  if (!Node.isMap()) {
+    return false;
+  }
+  auto &Map = Node.getMap();
+  auto Iter = Map.find(Key);
+  if (Iter == Map.end()) {
+    return false;
+  }
+  Value = Iter->second;
+  return true;
+}
+
+} // namespace
+
+amd_comgr_status_t MetadataQuery::create(StringRef Path,
+                                         MetadataQuery *&Query) {
+  std::unique_ptr<MetadataQuery> NewQuery(new (std::nothrow) MetadataQuery());
+  if (!NewQuery) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  if (Path.empty()) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  while (!Path.empty()) {
+    Step S;
+
+    if (!Path.consume_front("[")) {
+      S.Kind = StepKind::Key;
+      size_t End = Path.find('[');
+      S.Key = Path.substr(0, End).str();
+      Path = Path.substr(S.Key.size());
+      NewQuery->Steps.push_back(std::move(S));
+      continue;
+    }
+
+    if (!Path.empty() && isDigit(Path.front())) {
+      // An index, unless the digits begin the key of a filter.
+      StringRef Rest = Path;
+      if (!Rest.consumeInteger(10, S.Index) && Rest.consume_front("]")) {
+        S.Kind = StepKind::Index;
+        Path = Rest;
+        NewQuery->Steps.push_back(std::move(S));
+        continue;
+      }
+    }
+
+    if (Path.startswith("\"")) {
+      if (!parseString(Path, S.Key)) {
+        return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      }
+    } else {
+      size_t End = Path.find("==");
+      S.Key = Path.substr(0, End).str();
+      if (S.Key.empty() || S.Key.find_first_of("]\"") != std::string::npos) {
+        return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      }
+      Path = Path.substr(S.Key.size());
+    }
+
+    if (Path.consume_front("]")) {
+      S.Kind = StepKind::Key;
+      NewQuery->Steps.push_back(std::move(S));
+      continue;
+    }
+
+    if (!Path.consume_front("==")) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    S.Kind = StepKind::Filter;
+    if (Path.startswith("\"")) {
+      S.ValueKind = LiteralKind::String;
+      if (!parseString(Path, S.StringValue)) {
+        return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      }
+    } else if (Path.consume_front("true")) {
+      S.ValueKind = LiteralKind::Boolean;
+      S.BoolValue = true;
+    } else if (Path.consume_front("false")) {
+      S.ValueKind = LiteralKind::Boolean;
+      S.BoolValue = false;
+    } else if (Path.startswith("-")) {
+      S.ValueKind = LiteralKind::Int;
+      if (Path.consumeInteger(10, S.IntValue)) {
+        return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      }
+    } else {
+      S.ValueKind = LiteralKind::UInt;
+      if (Path.consumeInteger(10, S.UIntValue)) {
+        return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      }
+    }
+
+    if (!Path.consume_front("]")) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    NewQuery->Steps.push_back(std::move(S));
+  }
+
+  Query = NewQuery.release();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+bool MetadataQuery::matches(msgpack::DocNode Node, const Step &S) {
+  switch (S.ValueKind) {
+  case LiteralKind::String:
+    return Node.getKind() == msgpack::Type::String &&
+           Node.getString() == S.StringValue;
+  case LiteralKind::Int:
+    return Node.getKind() == msgpack::Type::Int && Node.getInt() == S.IntValue;
+  case LiteralKind::UInt:
+    if (Node.getKind() == msgpack::Type::Int) {
+      return Node.getInt() >= 0 &&
+             static_cast<uint64_t>(Node.getInt()) == S.UIntValue;
+    }
+    return Node.getKind() == msgpack::Type::UInt &&
+           Node.getUInt() == S.UIntValue;
+  case LiteralKind::Boolean:
+    return Node.getKind() == msgpack::Type::Boolean &&
+           Node.getBool() == S.BoolValue;
+  }
+  return false;
+}
+
+bool MetadataQuery::evaluate(msgpack::DocNode Root,
+                             msgpack::DocNode &Result) const {
+  msgpack::DocNode Node = Root;
+
+  for (const Step &S : Steps) {
+    switch (S.Kind) {
+    case StepKind::Key:
+      if (!findKey(Node, S.Key, Node)) {
+        return false;
+      }
+      break;
+    case StepKind::Index: {
+      if (!Node.isArray() || S.Index >= Node.getArray().size()) {
+        return false;
+      }
+      Node = *(Node.getArray().begin() + S.Index);
+      break;
+    }
+    case StepKind::Filter: {
+      if (!Node.isArray()) {
+        return false;
+      }
+      bool Found = false;
+      for (msgpack::DocNode Element : Node.getArray()) {
+        msgpack::DocNode Value;
+        if (findKey(Element, S.Key, Value) && matches(Value, S)) {
+          Node = Element;
+          Found = true;
+          break;
+        }
+      }
+      if (!Found) {
+        return false;
+      }
+      break;
+    }
+    }
+  }
+
+  Result = Node;
+  return true;
+}
+
+} // namespace COMGR
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_METADATA_QUERY_H
+#define COMGR_METADATA_QUERY_H
+
+#include "comgr.h"
+#include <string>
+#include <vector>
+
+namespace COMGR {
+
+/// A path expression over metadata, parsed once so that it can be evaluated
+/// against many metadata roots without creating intermediate nodes.
+///
+/// A path is a sequence of steps, each applied to the node selected by the
+/// previous step:
+///
+///   key           Look up a map entry. The key extends up to the next '[' or
+///                 the end of the path, so "amdhsa.kernels" and ".name" are
+///                 single keys.
+///   ["key"]       Look up a map entry, for keys containing '['.
+///   [N]           Index a list.
+///   [key==value]  Select the first map in a list whose entry for key equals
+///                 value, which is a quoted string, an integer, true or false.
+///                 The key may also be quoted.
+///
+/// For example, amdhsa.kernels[.name=="foo"].kernarg_segment_size.
+class MetadataQuery {
+public:
+  static amd_comgr_metadata_query_t convert(MetadataQuery *Query) {
+    amd_comgr_metadata_query_t Handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(Query))};
+    return Handle;
+  }
+
+  static const amd_comgr_metadata_query_t convert(const MetadataQuery *Query) {
+    const amd_comgr_metadata_query_t Handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(Query))};
+    return Handle;
+  }
+
+  static MetadataQuery *convert(amd_comgr_metadata_query_t Query) {
+    return reinterpret_cast<MetadataQuery *>(Query.handle);
+  }
+
+  /// Parse \p Path, returning AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT if it is
+  /// not a valid path.
+  static amd_comgr_status_t create(llvm::StringRef Path,
+                                   MetadataQuery *&Query);
+
+  /// Evaluate the query starting at \p Root. Returns false, leaving \p Result
+  /// unchanged, if a step does not match.
+  bool evaluate(llvm::msgpack::DocNode Root,
+                llvm::msgpack::DocNode &Result) const;
+
+private:
+  enum class StepKind { Key, Index, Filter };
+  enum class LiteralKind { String, Int, UInt, Boolean };
+
+  struct Step {
+    StepKind Kind;
+    std::string Key;
+    uint64_t Index = 0;
+    // The value a filter compares the entry for Key with.
+    LiteralKind ValueKind = LiteralKind::String;
+    std::string StringValue;
+    int64_t IntValue = 0;
+    uint64_t UIntValue = 0;
+    bool BoolValue = false;
+  };
+
+  static bool matches(llvm::msgpack::DocNode Node, const Step &S);
+
+  std::vector<Step> Steps;
+};
+
+} // namespace COMGR
+
+#endif // COMGR_METADATA_QUERY_H
@@ -37,13 +37,17 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/BinaryFormat/MsgPackWriter.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/AMDGPUMetadata.h"
 #include "llvm/Support/BinaryStreamReader.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cmath>
 #include <cstddef>
 #include <iostream>
 
@@ -329,7 +333,28 @@ static amd_comgr_status_t getElfMetadataRoot(const ELFObjectFile<ELFT> *Obj,
   return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
 }
 
+// Data objects of kind AMD_COMGR_DATA_KIND_MSGPACK and
+// AMD_COMGR_DATA_KIND_DIAGNOSTIC hold a bare MsgPack document, such as the
+// reports produced by the analysis actions.
+static amd_comgr_status_t getMsgPackMetadataRoot(DataObject *DataP,
+                                                 DataMeta *MetaP) {
+  MetaP->MetaDoc->EmitIntegerBooleans = false;
+  MetaP->MetaDoc->RawDocument = std::string(DataP->Data, DataP->Size);
+  if (!MetaP->MetaDoc->Document.readFromBlob(MetaP->MetaDoc->RawDocument,
+                                             false)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  MetaP->DocNode = MetaP->MetaDoc->Document.getRoot();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t getMetadataRoot(DataObject *DataP, DataMeta *MetaP) {
+  if (DataP->DataKind == AMD_COMGR_DATA_KIND_MSGPACK ||
+      DataP->DataKind == AMD_COMGR_DATA_KIND_DIAGNOSTIC) {
+    return getMsgPackMetadataRoot(DataP, MetaP);
+  }
+
   auto ObjOrErr = getELFObjectFileBase(DataP);
   if (errorToBool(ObjOrErr.takeError())) {
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
@@ -349,6 +374,147 @@ amd_comgr_status_t getMetadataRoot(DataObject *DataP, DataMeta *MetaP) {
   return getElfMetadataRoot(ELF64BE, MetaP);
 }
 
+static void writeMsgPackNode(msgpack::Writer &Writer, msgpack::DocNode Node) {
+  switch (Node.getKind()) {
+  case msgpack::Type::Int:
+    Writer.write(Node.getInt());
+    break;
+  case msgpack::Type::UInt:
+    Writer.write(Node.getUInt());
+    break;
+  case msgpack::Type::Boolean:
+    Writer.write(Node.getBool());
+    break;
+  case msgpack::Type::Float:
+    Writer.write(Node.getFloat());
+    break;
+  case msgpack::Type::String:
+    Writer.write(Node.getString());
+    break;
+  case msgpack::Type::Map:
+    Writer.writeMapSize(Node.getMap().size());
+    for (auto &KV : Node.getMap()) {
+      writeMsgPackNode(Writer, KV.first);
+      writeMsgPackNode(Writer, KV.second);
+    }
+    break;
+  case msgpack::Type::Array:
+    Writer.writeArraySize(Node.getArray().size());
+    for (auto &Element : Node.getArray()) {
+      writeMsgPackNode(Writer, Element);
+    }
+    break;
+  default:
+    Writer.writeNil();
+    break;
+  }
+}
+
+// JSON strings must be valid UTF-8, while MsgPack strings may hold anything.
+static std::string toJSONString(StringRef String) {
+  return json::isUTF8(String) ? String.str() : json::fixUTF8(String);
+}
+
+// JSON keys are strings, so map keys which are maps or arrays have no JSON
+// form. They are found before writing, as json::OStream must not be left with
+// an object or array open.
+static bool hasOnlyScalarKeys(msgpack::DocNode Node) {
+  switch (Node.getKind()) {
+  case msgpack::Type::Map:
+    for (auto &KV : Node.getMap()) {
+      msgpack::DocNode Key = KV.first;
+      if (!Key.isScalar() || !hasOnlyScalarKeys(KV.second)) {
+        return false;
+      }
+    }
+    return true;
+  case msgpack::Type::Array:
+    for (auto &Element : Node.getArray()) {
+      if (!hasOnlyScalarKeys(Element)) {
+        return false;
+      }
+    }
+    return true;
+  default:
+    return true;
+  }
+}
+
+static void writeJSONNode(json::OStream &JOS, msgpack::DocNode Node) {
+  switch (Node.getKind()) {
+  case msgpack::Type::Int:
+    JOS.value(Node.getInt());
+    break;
+  case msgpack::Type::UInt:
+    JOS.value(Node.getUInt());
+    break;
+  case msgpack::Type::Boolean:
+    JOS.value(Node.getBool());
+    break;
+  case msgpack::Type::Float:
+    if (std::isfinite(Node.getFloat())) {
+      JOS.value(Node.getFloat());
+    } else {
+      JOS.value(nullptr);
+    }
+    break;
+  case msgpack::Type::String:
+    JOS.value(toJSONString(Node.getString()));
+    break;
+  case msgpack::Type::Map:
+    JOS.objectBegin();
+    for (auto &KV : Node.getMap()) {
+      // Scalar keys other than strings use their text form.
+      msgpack::DocNode Key = KV.first;
+      JOS.attributeBegin(toJSONString(Key.getKind() == msgpack::Type::String
+                                          ? Key.getString()
+                                          : Key.toString()));
+      writeJSONNode(JOS, KV.second);
+      JOS.attributeEnd();
+    }
+    JOS.objectEnd();
+    break;
+  case msgpack::Type::Array:
+    JOS.arrayBegin();
+    for (auto &Element : Node.getArray()) {
+      writeJSONNode(JOS, Element);
+    }
+    JOS.arrayEnd();
+    break;
+  default:
+    JOS.value(nullptr);
+    break;
+  }
+}
+
+amd_comgr_status_t exportMetadata(msgpack::DocNode Node,
+                                  amd_comgr_metadata_format_t Format,
+                                  std::string &Blob) {
+  Blob.clear();
+  raw_string_ostream OS(Blob);
+
+  switch (Format) {
+  case AMD_COMGR_METADATA_FORMAT_MSGPACK: {
+    msgpack::Writer Writer(OS);
+    writeMsgPackNode(Writer, Node);
+    break;
+  }
+  case AMD_COMGR_METADATA_FORMAT_JSON: {
+    if (!hasOnlyScalarKeys(Node)) {
+      return AMD_COMGR_STATUS_ERROR;
+    }
+    json::OStream JOS(OS);
+    writeJSONNode(JOS, Node);
+    break;
+  }
+  default:
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  OS.flush();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 struct IsaInfo {
   const char *IsaName;
   const char *Processor;
@@ -1003,32 +1169,32 @@ lookUpCodeObjectInSharedObject(DataObject *DataP,
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
-amd_comgr_status_t lookUpCodeObject(DataObject *DataP,
-                                    amd_comgr_code_object_info_t *QueryList,
-                                    size_t QueryListSize) {
-
-  if (DataP->DataKind == AMD_COMGR_DATA_KIND_EXECUTABLE) {
-    return lookUpCodeObjectInSharedObject(DataP, QueryList, QueryListSize);
-  }
-
+// Match the entries of a clang offload bundle of BundleSize bytes against
+// QueryList. The Reader must be positioned just past the bundle magic string,
+// and may only cover a prefix of the bundle. If parsing fails because the
+// header or entry table extends past the end of the Reader, rather than past
+// the end of the bundle, Truncated is set.
+static amd_comgr_status_t
+lookUpBundleEntries(BinaryStreamReader &Reader, uint64_t BundleSize,
+                    amd_comgr_code_object_info_t *QueryList,
+                    size_t QueryListSize, bool &Truncated) {
   int Seen = 0;
-  BinaryStreamReader Reader(StringRef(DataP->Data, DataP->Size),
-                            support::little);
+  Truncated = false;
 
-  StringRef Magic;
-  if (auto EC = Reader.readFixedString(Magic, OffloadBundleMagicLen)) {
+  auto ReadFailed = [&](Error EC, uint64_t Needed) {
+    consumeError(std::move(EC));
+    Truncated = Needed <= BundleSize - Reader.getOffset();
     return AMD_COMGR_STATUS_ERROR;
-  }
-
-  if (Magic != CLANG_OFFLOAD_BUNDLER_MAGIC) {
-    if (DataP->DataKind == AMD_COMGR_DATA_KIND_BYTES) {
-      return lookUpCodeObjectInSharedObject(DataP, QueryList, QueryListSize);
-    }
-    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
-  }
+  };
 
   uint64_t NumOfCodeObjects;
   if (auto EC = Reader.readInteger(NumOfCodeObjects)) {
+    return ReadFailed(std::move(EC), sizeof(NumOfCodeObjects));
+  }
+
+  // Each entry holds at least its offset, size and ID size.
+  const uint64_t MinEntrySize = 3 * sizeof(uint64_t);
+  if (NumOfCodeObjects > (BundleSize - Reader.getOffset()) / MinEntrySize) {
     return AMD_COMGR_STATUS_ERROR;
   }
 
@@ -1046,19 +1212,19 @@ amd_comgr_status_t lookUpCodeObject(DataObject *DataP,
     StringRef BundleEntryID;
 
     if (auto EC = Reader.readInteger(BundleEntryCodeObjectOffset)) {
-      return AMD_COMGR_STATUS_ERROR;
+      return ReadFailed(std::move(EC), sizeof(BundleEntryCodeObjectOffset));
     }
 
-    if (auto Status = Reader.readInteger(BundleEntryCodeObjectSize)) {
-      return AMD_COMGR_STATUS_ERROR;
+    if (auto EC = Reader.readInteger(BundleEntryCodeObjectSize)) {
+      return ReadFailed(std::move(EC), sizeof(BundleEntryCodeObjectSize));
     }
 
-    if (auto Status = Reader.readInteger(BundleEntryIDSize)) {
-      return AMD_COMGR_STATUS_ERROR;
+    if (auto EC = Reader.readInteger(BundleEntryIDSize)) {
+      return ReadFailed(std::move(EC), sizeof(BundleEntryIDSize));
     }
 
-    if (Reader.readFixedString(BundleEntryID, BundleEntryIDSize)) {
-      return AMD_COMGR_STATUS_ERROR;
+    if (auto EC = Reader.readFixedString(BundleEntryID, BundleEntryIDSize)) {
+      return ReadFailed(std::move(EC), BundleEntryIDSize);
     }
 
     const auto OffloadAndTargetId = BundleEntryID.split('-');
@@ -1096,5 +1262,113 @@ amd_comgr_status_t lookUpCodeObject(DataObject *DataP,
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+amd_comgr_status_t lookUpCodeObject(DataObject *DataP,
+                                    amd_comgr_code_object_info_t *QueryList,
+                                    size_t QueryListSize) {
+
+  if (DataP->DataKind == AMD_COMGR_DATA_KIND_EXECUTABLE) {
+    return lookUpCodeObjectInSharedObject(DataP, QueryList, QueryListSize);
+  }
+
+  BinaryStreamReader Reader(StringRef(DataP->Data, DataP->Size),
+                            support::little);
+
+  StringRef Magic;
+  if (auto EC = Reader.readFixedString(Magic, OffloadBundleMagicLen)) {
+    consumeError(std::move(EC));
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  if (Magic != CLANG_OFFLOAD_BUNDLER_MAGIC) {
+    if (DataP->DataKind == AMD_COMGR_DATA_KIND_BYTES) {
+      return lookUpCodeObjectInSharedObject(DataP, QueryList, QueryListSize);
+    }
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  bool Truncated;
+  return lookUpBundleEntries(Reader, DataP->Size, QueryList, QueryListSize,
+                             Truncated);
+}
+
+// Initial number of bytes read from the file when looking for the bundle
+// entry table. This covers the header of bundles with a few dozen entries;
+// larger tables are handled by growing the read window.
+static constexpr size_t BundleHeaderReadSize = 4096;
+
+amd_comgr_status_t
+lookUpCodeObjectFromFile(int FD, uint64_t Offset, uint64_t Size,
+                         amd_comgr_code_object_info_t *QueryList,
+                         size_t QueryListSize) {
+  auto FileHandle = sys::fs::convertFDToNativeFile(FD);
+
+  // Only read the bundle header and entry table with positioned reads, so the
+  // code objects themselves are never touched. If the entry table does not
+  // fit in the window, grow it and parse again. A bundle that is malformed
+  // rather than truncated is rejected at once, so it never causes more of the
+  // slice to be read.
+  std::vector<char> Header;
+  size_t WindowSize = std::min<uint64_t>(BundleHeaderReadSize, Size);
+  while (true) {
+    Header.resize(WindowSize);
+    Expected<size_t> BytesRead = sys::fs::readNativeFileSlice(
+        FileHandle, MutableArrayRef<char>(Header), Offset);
+    if (!BytesRead) {
+      consumeError(BytesRead.takeError());
+      return AMD_COMGR_STATUS_ERROR;
+    }
+    Header.resize(*BytesRead);
+
+    BinaryStreamReader Reader(StringRef(Header.data(), Header.size()),
+                              support::little);
+
+    StringRef Magic;
+    if (auto EC = Reader.readFixedString(Magic, OffloadBundleMagicLen)) {
+      consumeError(std::move(EC));
+      return AMD_COMGR_STATUS_ERROR;
+    }
+
+    if (Magic != CLANG_OFFLOAD_BUNDLER_MAGIC) {
+      break;
+    }
+
+    bool Truncated;
+    amd_comgr_status_t Status =
+        lookUpBundleEntries(Reader, Size, QueryList, QueryListSize, Truncated);
+    if (Status == AMD_COMGR_STATUS_SUCCESS) {
+      return Status;
+    }
+    if (!Truncated) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    if (*BytesRead < WindowSize || WindowSize == Size) {
+      return Status;
+    }
+
+    WindowSize = std::min<uint64_t>(WindowSize * 2, Size);
+  }
+
+  // Not an offload bundle, so treat the slice as an executable shared object.
+  // The slice is mapped rather than read, so only the pages holding the ELF
+  // header and notes are brought in.
+  auto BufferOrErr = MemoryBuffer::getOpenFileSlice(
+      FileHandle, "" /* Name not set */, Size, Offset);
+  if (BufferOrErr.getError()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  DataObject *DataP = DataObject::allocate(AMD_COMGR_DATA_KIND_EXECUTABLE);
+  if (!DataP) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+  ScopedDataObjectReleaser SDOR(DataP);
+
+  if (auto Status = DataP->setData(std::move(*BufferOrErr))) {
+    return Status;
+  }
+
+  return lookUpCodeObjectInSharedObject(DataP, QueryList, QueryListSize);
+}
+
 } // namespace metadata
 } // namespace COMGR
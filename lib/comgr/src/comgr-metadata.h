@@ -46,6 +46,11 @@ namespace metadata {
 
 amd_comgr_status_t getMetadataRoot(DataObject *DataP, DataMeta *MetaP);
 
+/// Serialize the metadata rooted at \p Node to \p Blob in \p Format.
+amd_comgr_status_t exportMetadata(llvm::msgpack::DocNode Node,
+                                  amd_comgr_metadata_format_t Format,
+                                  std::string &Blob);
+
 size_t getIsaCount();
 
 const char *getIsaName(size_t Index);
@@ -61,6 +66,11 @@ amd_comgr_status_t lookUpCodeObject(DataObject *DataP,
                                     amd_comgr_code_object_info_t *QueryList,
                                     size_t QueryListsize);
 
+amd_comgr_status_t
+lookUpCodeObjectFromFile(int FD, uint64_t Offset, uint64_t Size,
+                         amd_comgr_code_object_info_t *QueryList,
+                         size_t QueryListSize);
+
 amd_comgr_status_t getIsaIndex(const llvm::StringRef IsaName, size_t &Index);
 
 bool isSupportedFeature(size_t IsaIndex, llvm::StringRef Feature);
@@ -37,10 +37,12 @@
  ******************************************************************************/
 
 #include "comgr-objdump.h"
+#include "comgr-statistics.h"
 #include "comgr.h"
 #include "lld/Common/TargetOptionsCommandFlags.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
@@ -74,17 +76,23 @@
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/Triple.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <system_error>
 #include <unordered_map>
 #include <utility>
@@ -114,6 +122,11 @@ static cl::list<std::string>
     DisassembleFunctions("df", cl::CommaSeparated,
                          cl::desc("List of functions to disassemble"));
 
+static cl::list<std::string> DisassembleRanges(
+    "disassemble-range", cl::CommaSeparated,
+    cl::desc("List of <start>-<end> address ranges. Only functions "
+             "overlapping them are disassembled"));
+
 cl::opt<bool>
     Relocations("reloc",
                 cl::desc("Display the relocation entries in the file"));
@@ -450,22 +463,80 @@ static bool relocAddressLess(RelocationRef A, RelocationRef B) {
 }
 
 namespace {
+// Byte offset and length of each line of a source file.
+using LineIndex = std::vector<std::pair<size_t, size_t>>;
+
+// Maximum number of line indices kept by getLineIndex.
+static const size_t MaxCachedLineIndices = 256;
+
+// Return the line index of Contents. Indices are shared across disassembly
+// actions and keyed by the hash and size of the contents, so repeatedly
+// annotating the same sources only splits them into lines once.
+static std::shared_ptr<const LineIndex> getLineIndex(StringRef Contents) {
+  static std::mutex LineIndexMutex;
+  static std::map<std::pair<uint64_t, size_t>, std::shared_ptr<const LineIndex>>
+      LineIndexCache;
+
+  auto Key = std::make_pair(xxHash64(Contents), Contents.size());
+  {
+    std::lock_guard<std::mutex> Lock(LineIndexMutex);
+    auto It = LineIndexCache.find(Key);
+    bool Hit = It != LineIndexCache.end();
+    COMGR::statistics::recordCacheLookup(
+        COMGR::statistics::CK_DisassemblySource, Hit);
+    if (Hit) {
+      return It->second;
+    }
+  }
+
+  auto Lines = std::make_shared<LineIndex>();
+  size_t Start = 0;
+  while (Start < Contents.size()) {
+    size_t End = Contents.find('\n', Start);
+    if (End == StringRef::npos) {
+      End = Contents.size();
+    }
+    size_t Length = End - Start;
+    if (Length && Contents[Start + Length - 1] == '\r') {
+      --Length;
+    }
+    Lines->emplace_back(Start, Length);
+    Start = End + 1;
+  }
+
+  std::lock_guard<std::mutex> Lock(LineIndexMutex);
+  if (LineIndexCache.size() >= MaxCachedLineIndices) {
+    LineIndexCache.clear();
+  }
+  return LineIndexCache.emplace(Key, std::move(Lines)).first->second;
+}
+
 class SourcePrinter {
 protected:
+  struct SourceFile {
+    StringRef Contents;
+    std::shared_ptr<const LineIndex> Lines;
+  };
+
   DILineInfo OldLineInfo;
   const ObjectFile *Obj = nullptr;
   std::unique_ptr<symbolize::LLVMSymbolizer> Symbolizer;
-  // File name to file contents of source
-  std::unordered_map<std::string, std::unique_ptr<MemoryBuffer>> SourceCache;
-  // Mark the line endings of the cached source
-  std::unordered_map<std::string, std::vector<StringRef>> LineCache;
+  // Sources supplied by the caller, keyed by data object name
+  const StringMap<StringRef> *SourceFiles = nullptr;
+  // Sources read from disk
+  std::vector<std::unique_ptr<MemoryBuffer>> SourceBuffers;
+  // File name from the debug info to the resolved source
+  std::unordered_map<std::string, SourceFile> SourceCache;
 
 private:
-  bool cacheSource(const std::string File);
+  bool findSourceFile(StringRef File, StringRef &Contents) const;
+  bool cacheSource(const std::string &File);
 
 public:
   SourcePrinter() = default;
-  SourcePrinter(const ObjectFile *Obj, StringRef DefaultArch) : Obj(Obj) {
+  SourcePrinter(const ObjectFile *Obj, StringRef DefaultArch,
+                const StringMap<StringRef> *SourceFiles = nullptr)
+      : Obj(Obj), SourceFiles(SourceFiles) {
     symbolize::LLVMSymbolizer::Options SymbolizerOpts;
     SymbolizerOpts.PrintFunctions = DILineInfoSpecifier::FunctionNameKind::None;
     SymbolizerOpts.Demangle = false;
@@ -478,26 +549,41 @@ public:
                                StringRef Delimiter = "; ");
 };
 
-bool SourcePrinter::cacheSource(const std::string File) {
-  auto BufferOrError = MemoryBuffer::getFile(File);
-  if (!BufferOrError) {
+// The debug info records the path a file was compiled from, which for data
+// objects is a temporary directory. Match the data object whose name is the
+// longest trailing path of File.
+bool SourcePrinter::findSourceFile(StringRef File, StringRef &Contents) const {
+  if (!SourceFiles) {
     return false;
   }
-  // Chomp the file to get lines
-  size_t BufferSize = (*BufferOrError)->getBufferSize();
-  const char *BufferStart = (*BufferOrError)->getBufferStart();
-  for (const char *Start = BufferStart, *End = BufferStart;
-       End < BufferStart + BufferSize; End++) {
-    if (*End == '\n' || End == BufferStart + BufferSize - 1 ||
-        (*End == '\r' && *(End + 1) == '\n')) {
-      LineCache[File].push_back(StringRef(Start, End - Start));
-      if (*End == '\r') {
-        End++;
-      }
-      Start = End + 1;
+
+  size_t BestLength = 0;
+  for (const auto &Entry : *SourceFiles) {
+    StringRef Name = Entry.getKey();
+    if (Name.empty() || Name.size() <= BestLength) {
+      continue;
+    }
+    if (File == Name ||
+        (File.size() > Name.size() && File.endswith(Name) &&
+         sys::path::is_separator(File[File.size() - Name.size() - 1]))) {
+      Contents = Entry.getValue();
+      BestLength = Name.size();
     }
   }
-  SourceCache[File] = std::move(*BufferOrError);
+  return BestLength != 0;
+}
+
+bool SourcePrinter::cacheSource(const std::string &File) {
+  StringRef Contents;
+  if (!findSourceFile(File, Contents)) {
+    auto BufferOrError = MemoryBuffer::getFile(File);
+    if (!BufferOrError) {
+      return false;
+    }
+    Contents = (*BufferOrError)->getBuffer();
+    SourceBuffers.push_back(std::move(*BufferOrError));
+  }
+  SourceCache[File] = {Contents, getLineIndex(Contents)};
   return true;
 }
 
@@ -508,8 +594,7 @@ void SourcePrinter::printSourceLine(raw_ostream &OS,
     return;
   }
   DILineInfo LineInfo = DILineInfo();
-  auto ExpectecLineInfo =
-      Symbolizer->symbolizeCode(std::string(Obj->getFileName()), Address);
+  auto ExpectecLineInfo = Symbolizer->symbolizeCode(*Obj, Address);
   if (!ExpectecLineInfo) {
     consumeError(ExpectecLineInfo.takeError());
   } else {
@@ -530,18 +615,14 @@ void SourcePrinter::printSourceLine(raw_ostream &OS,
         return;
       }
     }
-    auto FileBuffer = SourceCache.find(LineInfo.FileName);
-    if (FileBuffer != SourceCache.end()) {
-      auto LineBuffer = LineCache.find(LineInfo.FileName);
-      if (LineBuffer != LineCache.end()) {
-        if (LineInfo.Line > LineBuffer->second.size()) {
-          return;
-        }
-        // Vector begins at 0, line numbers are non-zero
-        OS << Delimiter << LineBuffer->second[LineInfo.Line - 1].ltrim()
-           << "\n";
-      }
+    const SourceFile &Source = SourceCache[LineInfo.FileName];
+    if (LineInfo.Line > Source.Lines->size()) {
+      return;
     }
+    // Vector begins at 0, line numbers are non-zero
+    auto Line = (*Source.Lines)[LineInfo.Line - 1];
+    OS << Delimiter << Source.Contents.substr(Line.first, Line.second).ltrim()
+       << "\n";
   }
   OldLineInfo = LineInfo;
 }
@@ -1260,12 +1341,81 @@ addDynamicElfSymbols(const ObjectFile *Obj,
   }
 }
 
-void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
-                                             bool InlineRelocs) {
+typedef std::pair<uint64_t, uint64_t> AddressRange;
+
+// Parse -disassemble-range into half-open [Start, End) ranges.
+static amd_comgr_status_t
+getDisassembleRanges(std::vector<AddressRange> &Ranges, raw_ostream &ErrS) {
+  for (StringRef Range : DisassembleRanges) {
+    auto [StartStr, EndStr] = Range.split('-');
+    uint64_t Start, End;
+    if (StartStr.getAsInteger(0, Start) || EndStr.getAsInteger(0, End) ||
+        Start >= End) {
+      ErrS << ToolName << ": invalid address range '" << Range << "'.\n";
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Ranges.emplace_back(Start, End);
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+// Return the indices, in increasing order, of the symbols in Symbols which
+// are named in Names or whose code overlaps one of Ranges. Symbols is sorted
+// by address, so ranges are found by binary search, and only the symbols
+// inside them are visited.
+static std::vector<unsigned>
+selectSymbols(const SectionSymbolsTy &Symbols, uint64_t SectionEnd,
+              const StringSet<> &Names, ArrayRef<AddressRange> Ranges) {
+  std::vector<unsigned> Indices;
+  if (!Names.empty()) {
+    for (unsigned Si = 0, Se = Symbols.size(); Si != Se; ++Si) {
+      if (Names.contains(Symbols[Si].Name)) {
+        Indices.push_back(Si);
+      }
+    }
+  }
+
+  for (const AddressRange &Range : Ranges) {
+    if (Range.first >= SectionEnd) {
+      continue;
+    }
+    // Start from the last symbol at or before the start of the range, which
+    // is the one containing it.
+    auto It = llvm::upper_bound(Symbols, Range.first,
+                                [](uint64_t Addr, const SymbolInfoTy &Sym) {
+                                  return Addr < Sym.Addr;
+                                });
+    if (It != Symbols.begin()) {
+      --It;
+    }
+    for (; It != Symbols.end() && It->Addr < Range.second; ++It) {
+      Indices.push_back(It - Symbols.begin());
+    }
+  }
+
+  llvm::sort(Indices);
+  Indices.erase(std::unique(Indices.begin(), Indices.end()), Indices.end());
+  return Indices;
+}
+
+amd_comgr_status_t
+llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
+                                        bool InlineRelocs) {
   if (StartAddress > StopAddress) {
     error("Start address should be less than stop address");
   }
 
+  // With -df or -disassemble-range only the selected functions are decoded.
+  StringSet<> FunctionNames;
+  for (const std::string &Name : DisassembleFunctions) {
+    FunctionNames.insert(Name);
+  }
+  std::vector<AddressRange> Ranges;
+  if (auto Status = getDisassembleRanges(Ranges, ErrS)) {
+    return Status;
+  }
+  bool IsFiltered = !FunctionNames.empty() || !Ranges.empty();
+
   const Target *TheTarget = getTarget(Obj);
 
   // Package up features to be passed to target/subtarget
@@ -1333,7 +1483,7 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
   StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  "
                                                : "\t\t\t%08" PRIx64 ":  ";
 
-  SourcePrinter SP(Obj, TheTarget->getName());
+  SourcePrinter SP(Obj, TheTarget->getName(), &SourceFiles);
 
   // Create a mapping, RelocSecs = SectionRelocMap[S], where sections
   // in RelocSecs contain the relocations for section S.
@@ -1453,6 +1603,29 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
 
     // Get the list of all the symbols in this section.
     SectionSymbolsTy &Symbols = AllSymbols[Section];
+    StringRef Name = unwrapOrError(Section.getName(), Obj->getFileName());
+
+    // If the section has no symbol at the start, just insert a dummy one.
+    if (Symbols.empty() || Symbols[0].Addr != 0) {
+      Symbols.insert(
+          Symbols.begin(),
+          SymbolInfoTy(SectionAddr, Name,
+                       Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
+    }
+
+    // Indices into Symbols of the symbols to disassemble.
+    std::vector<unsigned> SymbolIndices;
+    if (IsFiltered) {
+      SymbolIndices = selectSymbols(Symbols, SectionAddr + SectSize,
+                                    FunctionNames, Ranges);
+      if (SymbolIndices.empty()) {
+        continue;
+      }
+    } else {
+      SymbolIndices.resize(Symbols.size());
+      std::iota(SymbolIndices.begin(), SymbolIndices.end(), 0);
+    }
+
     std::vector<uint64_t> DataMappingSymsAddr;
     std::vector<uint64_t> TextMappingSymsAddr;
     if (isArmElf(Obj)) {
@@ -1506,7 +1679,6 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
       DataRefImpl DR = Section.getRawDataRefImpl();
       SegmentName = MachO->getSectionFinalSegmentName(DR);
     }
-    StringRef Name = unwrapOrError(Section.getName(), Obj->getFileName());
 
     if ((SectionAddr <= StopAddress) &&
         (SectionAddr + SectSize) >= StartAddress) {
@@ -1517,14 +1689,6 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
       OutS << Name << ':';
     }
 
-    // If the section has no symbol at the start, just insert a dummy one.
-    if (Symbols.empty() || Symbols[0].Addr != 0) {
-      Symbols.insert(
-          Symbols.begin(),
-          SymbolInfoTy(SectionAddr, Name,
-                       Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
-    }
-
     SmallString<40> Comments;
     raw_svector_ostream CommentStream(Comments);
 
@@ -1545,8 +1709,16 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
     std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
     std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
     // Disassemble symbol by symbol.
-    for (unsigned Si = 0, Se = Symbols.size(); Si != Se; ++Si) {
+    unsigned Se = Symbols.size();
+    for (unsigned Si : SymbolIndices) {
       uint64_t Start = Symbols[Si].Addr - SectionAddr;
+      // Skip the relocations of the symbols which were not selected.
+      if (IsFiltered) {
+        RelCur = std::lower_bound(RelCur, RelEnd, Start,
+                                  [](const RelocationRef &Rel, uint64_t Addr) {
+                                    return Rel.getOffset() < Addr;
+                                  });
+      }
       // The end is either the section end or the beginning of the next
       // symbol.
       uint64_t End =
@@ -1810,6 +1982,8 @@ void llvm::DisassemHelper::DisassembleObject(const ObjectFile *Obj,
       }
     }
   }
+
+  return AMD_COMGR_STATUS_SUCCESS;
 }
 
 void llvm::DisassemHelper::PrintRelocations(const ObjectFile *Obj) {
@@ -2245,8 +2419,8 @@ void llvm::DisassemHelper::printPrivateFileHeaders(const ObjectFile *O,
   reportError(O->getFileName(), "Invalid/Unsupported object file format");
 }
 
-void llvm::DisassemHelper::DumpObject(ObjectFile *O,
-                                      const Archive *A = nullptr) {
+amd_comgr_status_t
+llvm::DisassemHelper::DumpObject(ObjectFile *O, const Archive *A = nullptr) {
   StringRef ArchiveName = A != nullptr ? A->getFileName() : "";
   // Avoid other output when using a raw option.
   if (!RawClangAST) {
@@ -2260,7 +2434,9 @@ void llvm::DisassemHelper::DumpObject(ObjectFile *O,
   }
 
   if (Disassemble) {
-    DisassembleObject(O, Relocations);
+    if (auto Status = DisassembleObject(O, Relocations)) {
+      return Status;
+    }
   }
   if (Relocations && !Disassemble) {
     PrintRelocations(O);
@@ -2308,6 +2484,8 @@ void llvm::DisassemHelper::DumpObject(ObjectFile *O,
     DumpOpts.DumpType = DwarfDumpType;
     DICtx->dump(OutS, DumpOpts);
   }
+
+  return AMD_COMGR_STATUS_SUCCESS;
 }
 
 #ifdef NOT_LIBCOMGR
@@ -2328,7 +2506,7 @@ void llvm::DisassemHelper::DumpObject(const COFFImportFile *I,
 #endif
 
 /// @brief Dump each object file in \a a;
-void llvm::DisassemHelper::DumpArchive(const Archive *A) {
+amd_comgr_status_t llvm::DisassemHelper::DumpArchive(const Archive *A) {
   Error Err = Error::success();
   for (auto &C : A->children(Err)) {
     Expected<std::unique_ptr<Binary>> ChildOrErr = C.getAsBinary();
@@ -2339,7 +2517,9 @@ void llvm::DisassemHelper::DumpArchive(const Archive *A) {
       continue;
     }
     if (ObjectFile *O = dyn_cast<ObjectFile>(&*ChildOrErr.get())) {
-      DumpObject(O, A);
+      if (auto Status = DumpObject(O, A)) {
+        return Status;
+      }
 #ifdef NOT_LIBCOMGR
       else if (COFFImportFile *I = dyn_cast<COFFImportFile>(&*ChildOrErr.get()))
           DumpObject(I, a);
@@ -2351,6 +2531,8 @@ void llvm::DisassemHelper::DumpArchive(const Archive *A) {
   if (Err) {
     reportError(A->getFileName(), std::move(Err));
   }
+
+  return AMD_COMGR_STATUS_SUCCESS;
 }
 
 /// @brief Open file and figure out how to dump it.
@@ -2428,15 +2610,16 @@ llvm::DisassemHelper::disassembleAction(StringRef Input,
   }
   Binary &Binary = *BinaryOrErr.get().getBinary();
 
+  amd_comgr_status_t Status = AMD_COMGR_STATUS_SUCCESS;
   if (Archive *A = dyn_cast<Archive>(&Binary)) {
-    DumpArchive(A);
+    Status = DumpArchive(A);
   } else if (ObjectFile *O = dyn_cast<ObjectFile>(&Binary)) {
-    DumpObject(O);
+    Status = DumpObject(O);
   } else {
     reportError("comgr-objdump.cpp", object_error::invalid_file_type);
   }
 
   OutS.flush();
 
-  return AMD_COMGR_STATUS_SUCCESS;
+  return Status;
 }
@@ -40,6 +40,7 @@
 #define COMGR_OBJDUMP_H
 
 #include "comgr.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/Object/Archive.h"
 #include "llvm/Support/CommandLine.h"
@@ -62,8 +63,11 @@ class DisassemHelper {
 private:
   raw_ostream &OutS;
   raw_ostream &ErrS;
+  // Sources used to annotate disassembly (-S), keyed by data object name
+  StringMap<StringRef> SourceFiles;
 
-  void DisassembleObject(const object::ObjectFile *Obj, bool InlineRelocs);
+  amd_comgr_status_t DisassembleObject(const object::ObjectFile *Obj,
+                                       bool InlineRelocs);
   void PrintUnwindInfo(const object::ObjectFile *o);
   void printExportsTrie(const object::ObjectFile *o);
   void printRebaseTable(object::ObjectFile *o);
@@ -79,8 +83,9 @@ private:
   void printFaultMaps(const object::ObjectFile *Obj);
   void printPrivateFileHeaders(const object::ObjectFile *o, bool onlyFirst);
 
-  void DumpObject(object::ObjectFile *o, const object::Archive *a);
-  void DumpArchive(const object::Archive *a);
+  amd_comgr_status_t DumpObject(object::ObjectFile *o,
+                                const object::Archive *a);
+  amd_comgr_status_t DumpArchive(const object::Archive *a);
   void DumpInput(StringRef file);
 
   void printELFFileHeader(const object::ObjectFile *Obj);
@@ -89,6 +94,12 @@ public:
   DisassemHelper(raw_ostream &OutS, raw_ostream &ErrS)
       : OutS(OutS), ErrS(ErrS) {}
 
+  /// Make the source file Contents available to -S under Name. Debug info
+  /// file names are resolved against these before falling back to disk.
+  void addSourceFile(StringRef Name, StringRef Contents) {
+    SourceFiles[Name] = Contents;
+  }
+
   amd_comgr_status_t disassembleAction(StringRef Input,
                                        ArrayRef<std::string> Options);
 }; // DisassemHelper
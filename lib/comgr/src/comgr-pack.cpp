@@ -0,0 +1,219 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-pack.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::support;
+
+namespace COMGR {
+namespace pack {
+
+namespace {
+
+// A packed data set is a header, followed by one entry per data object, the
+// names of the data objects, and finally their payloads. Offsets are relative
+// to the start of the pack. Each payload starts on a PayloadAlignment
+// boundary within the pack, though the buffer it is unpacked from may not be
+// aligned in memory.
+const char PackMagic[8] = {'C', 'M', 'G', 'R', 'P', 'A', 'C', 'K'};
+const uint32_t PackVersion = 1;
+const uint64_t PayloadAlignment = 64;
+
+struct PackHeader {
+  char Magic[8];
+  ulittle32_t Version;
+  ulittle32_t Count;
+};
+static_assert(sizeof(PackHeader) == 16, "unexpected pack header size");
+
+struct PackEntry {
+  ulittle32_t Kind;
+  ulittle32_t NameSize;
+  ulittle64_t NameOffset;
+  ulittle64_t DataOffset;
+  ulittle64_t DataSize;
+};
+static_assert(sizeof(PackEntry) == 32, "unexpected pack entry size");
+
+// A slice of a packed data set. All slices share ownership of the underlying
+// buffer, which is typically a mapping of the file the pack was read from.
+class PackedSliceBuffer : public MemoryBuffer {
+public:
+  PackedSliceBuffer(std::shared_ptr<MemoryBuffer> Pack, StringRef Slice)
+      : Pack(std::move(Pack)) {
+    init(Slice.begin(), Slice.end(), /*RequiresNullTerminator=*/false);
+  }
+
+  BufferKind getBufferKind() const override { return Pack->getBufferKind(); }
+
+private:
+  std::shared_ptr<MemoryBuffer> Pack;
+};
+
+bool isInBounds(uint64_t Offset, uint64_t Size, uint64_t BufferSize) {
+  return Offset <= BufferSize && Size <= BufferSize - Offset;
+}
+
+} // namespace
+
+amd_comgr_status_t packDataSet(const DataSet *Set, std::string &Blob) {
+  const auto &Objects = Set->DataObjects;
+  if (Objects.size() > UINT32_MAX) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  SmallVector<PackEntry, 8> Entries(Objects.size());
+  uint64_t Offset = sizeof(PackHeader) + Objects.size() * sizeof(PackEntry);
+
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    size_t NameSize = Objects[I]->Name ? strlen(Objects[I]->Name) : 0;
+    if (NameSize > UINT32_MAX) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    Entries[I].Kind = Objects[I]->DataKind;
+    Entries[I].NameSize = NameSize;
+    Entries[I].NameOffset = Offset;
+    Offset += NameSize;
+  }
+
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    Offset = alignTo(Offset, PayloadAlignment);
+    Entries[I].DataOffset = Offset;
+    Entries[I].DataSize = Objects[I]->Size;
+    Offset += Objects[I]->Size;
+  }
+
+  Blob.assign(Offset, '\0');
+
+  PackHeader Header;
+  memcpy(Header.Magic, PackMagic, sizeof(PackMagic));
+  Header.Version = PackVersion;
+  Header.Count = Objects.size();
+  memcpy(&Blob[0], &Header, sizeof(Header));
+
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    memcpy(&Blob[sizeof(PackHeader) + I * sizeof(PackEntry)], &Entries[I],
+           sizeof(PackEntry));
+    if (Entries[I].NameSize) {
+      memcpy(&Blob[Entries[I].NameOffset], Objects[I]->Name,
+             Entries[I].NameSize);
+    }
+    if (Entries[I].DataSize) {
+      memcpy(&Blob[Entries[I].DataOffset], Objects[I]->Data,
+             Entries[I].DataSize);
+    }
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t unpackDataSet(std::unique_ptr<MemoryBuffer> Buffer,
+                                 DataSet *Set) {
+  std::shared_ptr<MemoryBuffer> Pack(std::move(Buffer));
+  StringRef Bytes = Pack->getBuffer();
+
+  // Validate the whole pack before creating any data objects, so a malformed
+  // pack leaves the data set untouched.
+  if (Bytes.size() < sizeof(PackHeader)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  PackHeader Header;
+  memcpy(&Header, Bytes.data(), sizeof(Header));
+  if (memcmp(Header.Magic, PackMagic, sizeof(PackMagic)) ||
+      Header.Version != PackVersion ||
+      Header.Count > (Bytes.size() - sizeof(PackHeader)) / sizeof(PackEntry)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  SmallVector<PackEntry, 8> Entries(Header.Count);
+  memcpy(Entries.data(), Bytes.data() + sizeof(PackHeader),
+         Header.Count * sizeof(PackEntry));
+
+  for (const PackEntry &Entry : Entries) {
+    auto Kind = static_cast<amd_comgr_data_kind_t>(uint32_t(Entry.Kind));
+    if (!isDataKindValid(Kind) || Kind == AMD_COMGR_DATA_KIND_UNDEF ||
+        !isInBounds(Entry.NameOffset, Entry.NameSize, Bytes.size()) ||
+        !isInBounds(Entry.DataOffset, Entry.DataSize, Bytes.size())) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  SmallVector<DataObject *, 8> Objects;
+  auto ReleaseObjects = [&Objects]() {
+    for (DataObject *Object : Objects) {
+      Object->release();
+    }
+  };
+
+  for (const PackEntry &Entry : Entries) {
+    DataObject *Object =
+        DataObject::allocate(static_cast<amd_comgr_data_kind_t>(
+            uint32_t(Entry.Kind)));
+    if (!Object) {
+      ReleaseObjects();
+      return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+    }
+    Objects.push_back(Object);
+
+    auto Slice = std::make_unique<PackedSliceBuffer>(
+        Pack, Bytes.substr(Entry.DataOffset, Entry.DataSize));
+    if (auto Status = Object->setName(
+            Bytes.substr(Entry.NameOffset, Entry.NameSize))) {
+      ReleaseObjects();
+      return Status;
+    }
+    if (auto Status = Object->setData(std::move(Slice))) {
+      ReleaseObjects();
+      return Status;
+    }
+  }
+
+  // The data set takes over the reference returned by allocate.
+  for (DataObject *Object : Objects) {
+    Set->DataObjects.insert(Object);
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace pack
+} // namespace COMGR
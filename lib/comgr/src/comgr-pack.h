@@ -0,0 +1,60 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_PACK_H
+#define COMGR_PACK_H
+
+#include "comgr.h"
+#include <memory>
+#include <string>
+
+namespace COMGR {
+namespace pack {
+
+/// Serialize every data object of \p Set, in the order they were added, into
+/// \p Blob using the packed data set format.
+amd_comgr_status_t packDataSet(const DataSet *Set, std::string &Blob);
+
+/// Add a data object to \p Set for each entry of the packed data set in
+/// \p Buffer. The data of each object references its slice of \p Buffer,
+/// which is kept alive until the last such object is released. \p Set is left
+/// unchanged if \p Buffer is not a valid packed data set.
+amd_comgr_status_t unpackDataSet(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                                 DataSet *Set);
+
+} // namespace pack
+} // namespace COMGR
+
+#endif // COMGR_PACK_H
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace COMGR {
+namespace scheduler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A waiting action gains one priority level for every AgingAdmissions other
+// actions admitted ahead of it, and for every AgingInterval it waits. Both
+// are long compared to a single action, so priorities decide the order in
+// all but a sustained backlog, which can then only delay an action a bounded
+// number of admissions.
+const uint64_t AgingAdmissions = 8;
+const Clock::duration AgingInterval = std::chrono::seconds(5);
+
+struct Waiter {
+  int Priority;
+  uint64_t Ticket;
+  Clock::time_point Arrival;
+  uint64_t AdmissionsAtArrival;
+};
+
+class Scheduler {
+public:
+  void acquire(amd_comgr_action_priority_t Priority) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    if (!Busy) {
+      Busy = true;
+      ++Admissions;
+      return;
+    }
+
+    uint64_t Ticket = NextTicket++;
+    Waiters.push_back(
+        {static_cast<int>(Priority), Ticket, Clock::now(), Admissions});
+    Admitted.wait(Lock, [&] { return AdmittedTicket == Ticket; });
+  }
+
+  void release() {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (Waiters.empty()) {
+        Busy = false;
+        return;
+      }
+
+      // Admit the waiter with the highest aged priority, and the earliest
+      // among those. There are only ever as many waiters as threads, so a
+      // scan is cheaper than keeping them ordered as they age.
+      Clock::time_point Now = Clock::now();
+      auto Rank = [&](const Waiter &W) {
+        uint64_t Passed = Admissions - W.AdmissionsAtArrival;
+        uint64_t Aging =
+            Passed / AgingAdmissions + (Now - W.Arrival) / AgingInterval;
+        uint64_t Levels = AMD_COMGR_ACTION_PRIORITY_LAST - W.Priority;
+        return W.Priority + static_cast<int>(std::min(Aging, Levels));
+      };
+      auto Next = Waiters.begin();
+      int NextRank = Rank(*Next);
+      for (auto It = std::next(Waiters.begin()); It != Waiters.end(); ++It) {
+        int ItRank = Rank(*It);
+        if (ItRank > NextRank ||
+            (ItRank == NextRank && It->Ticket < Next->Ticket)) {
+          Next = It;
+          NextRank = ItRank;
+        }
+      }
+
+      // Hand over directly, so an action arriving now cannot barge ahead of
+      // the waiters.
+      AdmittedTicket = Next->Ticket;
+      Waiters.erase(Next);
+      ++Admissions;
+    }
+    Admitted.notify_all();
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Admitted;
+  bool Busy = false;
+  uint64_t NextTicket = 0;
+  uint64_t AdmittedTicket = UINT64_MAX;
+  uint64_t Admissions = 0;
+  std::vector<Waiter> Waiters;
+};
+
+Scheduler &getScheduler() {
+  static Scheduler S;
+  return S;
+}
+
+} // namespace
+
+ScopedAdmission::ScopedAdmission(amd_comgr_action_priority_t Priority) {
+  getScheduler().acquire(Priority);
+}
+
+ScopedAdmission::~ScopedAdmission() { getScheduler().release(); }
+
+} // namespace scheduler
+} // namespace COMGR
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_SCHEDULER_H
+#define COMGR_SCHEDULER_H
+
+#include "amd_comgr.h"
+
+namespace COMGR {
+namespace scheduler {
+
+/// Holds the right to run an action for the lifetime of the object.
+///
+/// Actions are run one at a time. When the running action finishes, the
+/// waiting action with the highest priority is admitted next, and the one
+/// which arrived first among those, so a latency critical request does not
+/// queue behind background work. To keep low priority actions from starving,
+/// a waiting action ages: every AgingAdmissions actions admitted ahead of it,
+/// and every AgingInterval it waits, count as one priority level.
+class ScopedAdmission {
+public:
+  explicit ScopedAdmission(amd_comgr_action_priority_t Priority);
+  ~ScopedAdmission();
+
+  ScopedAdmission(const ScopedAdmission &) = delete;
+  ScopedAdmission &operator=(const ScopedAdmission &) = delete;
+};
+
+} // namespace scheduler
+} // namespace COMGR
+
+#endif // COMGR_SCHEDULER_H
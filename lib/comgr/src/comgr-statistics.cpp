@@ -0,0 +1,261 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-statistics.h"
+#include "comgr.h"
+#include "time-stat/ts-interface.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <mutex>
+
+using namespace llvm;
+
+namespace COMGR {
+namespace statistics {
+
+namespace {
+
+// Counters are updated with relaxed atomics, so recording never blocks and
+// statistics can be queried while actions run. Driver jobs are keyed by tool
+// name, and are recorded at most a few times per action, so a mutex guards
+// them.
+struct Statistics {
+  static constexpr unsigned NumActions = AMD_COMGR_ACTION_LAST + 1;
+  static constexpr unsigned NumStatuses =
+      AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES + 1;
+
+  std::atomic<uint64_t> Actions[NumActions][NumStatuses];
+  std::atomic<uint64_t> BytesIn;
+  std::atomic<uint64_t> BytesOut;
+  std::atomic<uint64_t> CacheHits[CK_Count];
+  std::atomic<uint64_t> CacheMisses[CK_Count];
+  std::atomic<uint64_t> TempFiles;
+  std::atomic<uint64_t> LLDInvocations;
+
+  std::mutex DriverJobsMutex;
+  StringMap<uint64_t> DriverJobs;
+
+  Statistics() { reset(); }
+
+  void reset() {
+    for (auto &Statuses : Actions) {
+      for (auto &Count : Statuses) {
+        Count = 0;
+      }
+    }
+    BytesIn = 0;
+    BytesOut = 0;
+    for (unsigned I = 0; I < CK_Count; ++I) {
+      CacheHits[I] = 0;
+      CacheMisses[I] = 0;
+    }
+    TempFiles = 0;
+    LLDInvocations = 0;
+
+    std::lock_guard<std::mutex> Lock(DriverJobsMutex);
+    DriverJobs.clear();
+  }
+};
+
+Statistics &getStats() {
+  static Statistics Stats;
+  return Stats;
+}
+
+const char *CacheNames[CK_Count] = {"symbolizer", "disassembly_source"};
+
+const char *StatusNames[Statistics::NumStatuses] = {
+    "success", "error", "invalid_argument", "out_of_resources"};
+
+void increment(std::atomic<uint64_t> &Counter, uint64_t Value = 1) {
+  Counter.fetch_add(Value, std::memory_order_relaxed);
+}
+
+uint64_t load(const std::atomic<uint64_t> &Counter) {
+  return Counter.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+void recordAction(amd_comgr_action_kind_t ActionKind,
+                  amd_comgr_status_t Status, uint64_t BytesIn,
+                  uint64_t BytesOut) {
+  Statistics &Stats = getStats();
+  if (ActionKind < Statistics::NumActions &&
+      Status < Statistics::NumStatuses) {
+    increment(Stats.Actions[ActionKind][Status]);
+  }
+  increment(Stats.BytesIn, BytesIn);
+  increment(Stats.BytesOut, BytesOut);
+}
+
+void recordCacheLookup(CacheKind Cache, bool Hit) {
+  Statistics &Stats = getStats();
+  increment(Hit ? Stats.CacheHits[Cache] : Stats.CacheMisses[Cache]);
+}
+
+void recordTempFile() { increment(getStats().TempFiles); }
+
+void recordDriverJob(StringRef Tool) {
+  Statistics &Stats = getStats();
+  std::lock_guard<std::mutex> Lock(Stats.DriverJobsMutex);
+  ++Stats.DriverJobs[Tool];
+}
+
+void recordLLDInvocation() { increment(getStats().LLDInvocations); }
+
+void getStatistics(std::string &Blob) {
+  Statistics &Stats = getStats();
+  msgpack::Document Doc;
+  auto Root = Doc.getRoot().getMap(/*Convert=*/true);
+
+  auto ActionsNode = Doc.getMapNode();
+  for (unsigned Kind = 0; Kind < Statistics::NumActions; ++Kind) {
+    auto StatusesNode = Doc.getMapNode();
+    bool Invoked = false;
+    for (unsigned Status = 0; Status < Statistics::NumStatuses; ++Status) {
+      uint64_t Count = load(Stats.Actions[Kind][Status]);
+      StatusesNode[StatusNames[Status]] = Doc.getNode(Count);
+      Invoked |= Count != 0;
+    }
+    if (Invoked) {
+      StringRef Name =
+          getActionKindName(static_cast<amd_comgr_action_kind_t>(Kind));
+      ActionsNode[Doc.getNode(Name, /*Copy=*/true)] = StatusesNode;
+    }
+  }
+  Root["actions"] = ActionsNode;
+  Root["bytes_in"] = Doc.getNode(load(Stats.BytesIn));
+  Root["bytes_out"] = Doc.getNode(load(Stats.BytesOut));
+
+  auto CachesNode = Doc.getMapNode();
+  for (unsigned I = 0; I < CK_Count; ++I) {
+    auto CacheNode = Doc.getMapNode();
+    CacheNode["hits"] = Doc.getNode(load(Stats.CacheHits[I]));
+    CacheNode["misses"] = Doc.getNode(load(Stats.CacheMisses[I]));
+    CachesNode[CacheNames[I]] = CacheNode;
+  }
+  Root["caches"] = CachesNode;
+
+  auto ProfilePointsNode = Doc.getMapNode();
+  TimeStatistics::getProfilePointTotals(
+      [&](StringRef Name, uint64_t Count, uint64_t Nanoseconds) {
+        auto PointNode = Doc.getMapNode();
+        PointNode["count"] = Doc.getNode(Count);
+        PointNode["time_ns"] = Doc.getNode(Nanoseconds);
+        ProfilePointsNode[Doc.getNode(Name, /*Copy=*/true)] = PointNode;
+      });
+  Root["profile_points"] = ProfilePointsNode;
+
+  Root["temp_files"] = Doc.getNode(load(Stats.TempFiles));
+
+  auto DriverJobsNode = Doc.getMapNode();
+  {
+    std::lock_guard<std::mutex> Lock(Stats.DriverJobsMutex);
+    for (const auto &Job : Stats.DriverJobs) {
+      DriverJobsNode[Doc.getNode(Job.getKey(), /*Copy=*/true)] =
+          Doc.getNode(Job.getValue());
+    }
+  }
+  Root["driver_jobs"] = DriverJobsNode;
+  Root["lld_invocations"] = Doc.getNode(load(Stats.LLDInvocations));
+
+  Doc.writeToBlob(Blob);
+}
+
+void resetStatistics() {
+  getStats().reset();
+  TimeStatistics::resetProfilePoints();
+}
+
+// LLVM offers no way to undo EnableStatistics(), which would leave every later
+// action counting statistics. Collection is instead controlled by the -stats
+// option, which clearLLVMOptions() resets before each job.
+static std::atomic<bool> CollectingLLVMStatistics(false);
+
+static void setLLVMStatisticsOption() {
+  const char *Args[] = {"", "-stats"};
+  cl::ParseCommandLineOptions(2, Args, "LLVM statistics");
+}
+
+void beginLLVMStatistics() {
+  CollectingLLVMStatistics = true;
+  clearLLVMOptions();
+  ResetStatistics();
+}
+
+void restoreLLVMStatistics() {
+  if (CollectingLLVMStatistics) {
+    setLLVMStatisticsOption();
+  }
+}
+
+void endLLVMStatistics(std::string &Blob) {
+  // Only the JSON form qualifies statistic names by their pass, and LLVM
+  // offers no other way to enumerate them together with their debug type.
+  std::string JSON;
+  raw_string_ostream OS(JSON);
+  PrintStatisticsJSON(OS);
+  OS.flush();
+  ResetStatistics();
+
+  msgpack::Document Doc;
+  auto Root = Doc.getRoot().getMap(/*Convert=*/true);
+  Expected<json::Value> Parsed = json::parse(JSON);
+  if (!Parsed) {
+    consumeError(Parsed.takeError());
+  } else if (const json::Object *Stats = Parsed->getAsObject()) {
+    // Timer values are printed as floating point numbers, and are skipped.
+    for (const auto &Stat : *Stats) {
+      if (auto Value = Stat.second.getAsUINT64()) {
+        Root[Doc.getNode(StringRef(Stat.first), /*Copy=*/true)] =
+            Doc.getNode(*Value);
+      }
+    }
+  }
+
+  Doc.writeToBlob(Blob);
+
+  CollectingLLVMStatistics = false;
+  clearLLVMOptions();
+}
+
+} // namespace statistics
+} // namespace COMGR
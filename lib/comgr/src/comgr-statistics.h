@@ -0,0 +1,126 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_STATISTICS_H
+#define COMGR_STATISTICS_H
+
+#include "amd_comgr.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace COMGR {
+namespace statistics {
+
+/// The caches whose lookups are counted.
+enum CacheKind {
+  CK_Symbolizer,
+  CK_DisassemblySource,
+  CK_Count
+};
+
+/// Record the completion of an action, the total size of its input data
+/// objects, and the total size of the data objects it added to its result.
+void recordAction(amd_comgr_action_kind_t ActionKind,
+                  amd_comgr_status_t Status, uint64_t BytesIn,
+                  uint64_t BytesOut);
+
+/// Record a lookup in \p Cache.
+void recordCacheLookup(CacheKind Cache, bool Hit);
+
+/// Record a temporary file written for an action.
+void recordTempFile();
+
+/// Record a driver job run in-process, by the name of the tool creating it.
+void recordDriverJob(llvm::StringRef Tool);
+
+/// Record an invocation of lld.
+void recordLLDInvocation();
+
+/// Write a MsgPack map of the statistics recorded since the last reset to
+/// \p Blob.
+void getStatistics(std::string &Blob);
+
+/// Restart all statistics from zero.
+void resetStatistics();
+
+/// Enable the statistics counted by LLVM passes and restart them from zero.
+/// Must only be called while no other action is performed.
+void beginLLVMStatistics();
+
+/// Write a MsgPack map from the name of each LLVM statistic counted since
+/// beginLLVMStatistics() to its value to \p Blob, restart them from zero, and
+/// disable them again.
+void endLLVMStatistics(std::string &Blob);
+
+/// Re-enable the statistics counted by LLVM passes if they are being
+/// collected. Called after the LLVM options, which control them, are reset.
+void restoreLLVMStatistics();
+
+/// Collects the statistics counted by LLVM passes for the lifetime of an
+/// action, if \p Enable. Collection is disabled again on every exit path,
+/// whether or not finish() was called.
+class LLVMStatisticsScope {
+  bool Active;
+
+public:
+  explicit LLVMStatisticsScope(bool Enable) : Active(Enable) {
+    if (Active) {
+      beginLLVMStatistics();
+    }
+  }
+  ~LLVMStatisticsScope() {
+    if (Active) {
+      std::string Blob;
+      endLLVMStatistics(Blob);
+    }
+  }
+
+  LLVMStatisticsScope(const LLVMStatisticsScope &) = delete;
+  LLVMStatisticsScope &operator=(const LLVMStatisticsScope &) = delete;
+
+  /// Stop collecting and write the statistics to \p Blob, as
+  /// endLLVMStatistics() does.
+  void finish(std::string &Blob) {
+    if (Active) {
+      endLLVMStatistics(Blob);
+      Active = false;
+    }
+  }
+};
+
+} // namespace statistics
+} // namespace COMGR
+
+#endif // COMGR_STATISTICS_H
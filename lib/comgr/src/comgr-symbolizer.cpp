@@ -39,14 +39,130 @@
 
 #include "llvm/DebugInfo/Symbolize/SymbolizableObjectFile.h"
 #include "comgr-symbolizer.h"
+#include "comgr-env.h"
+#include "comgr-statistics.h"
 #include "llvm/BinaryFormat/Magic.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/Demangle/Demangle.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
 
 using namespace COMGR;
 
+namespace {
+
+// The parsed symbol table and debug information of one code object. The
+// module is built over a private copy of the code object, so it does not
+// depend on the lifetime of the data object of any symbolizer handle. If the
+// code object cannot be parsed, Module is null and nothing else is kept, so
+// that the failure is not retried on every query.
+struct CachedModule {
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<ObjectFile> Object;
+  std::unique_ptr<SymbolizableModule> Module;
+  // DWARF is parsed lazily as addresses are queried, so queries of one module
+  // are serialized.
+  std::mutex Mutex;
+};
+
+// Process-wide cache of modules shared by all symbolizer handles, keyed by
+// code object content. Once the total size of the cached code objects exceeds
+// the limit, the least recently used modules are dropped. The limit counts
+// code object bytes, not the larger footprint of the copy and the DWARF parsed
+// from it. A module still in use by a query is freed when the query completes.
+class SymbolizerCache {
+public:
+  using Key = std::pair<uint64_t, size_t>;
+
+  static SymbolizerCache &get() {
+    static SymbolizerCache Cache;
+    return Cache;
+  }
+
+  std::shared_ptr<CachedModule> lookup(const Key &K) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Index.find(K);
+    if (It == Index.end()) {
+      return nullptr;
+    }
+    LRU.splice(LRU.begin(), LRU, It->second);
+    return It->second->second;
+  }
+
+  // Add Module under K, unless another thread added one first, and return
+  // the cached module.
+  std::shared_ptr<CachedModule> insert(const Key &K,
+                                       std::shared_ptr<CachedModule> Module) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Index.find(K);
+    if (It != Index.end()) {
+      LRU.splice(LRU.begin(), LRU, It->second);
+      return It->second->second;
+    }
+
+    LRU.emplace_front(K, std::move(Module));
+    Index[K] = LRU.begin();
+    Size += K.second;
+
+    // The most recently used module is always kept.
+    while (Size > Limit && LRU.size() > 1) {
+      Size -= LRU.back().first.second;
+      Index.erase(LRU.back().first);
+      LRU.pop_back();
+    }
+    return LRU.front().second;
+  }
+
+private:
+  SymbolizerCache() : Limit(env::getSymbolizerCacheSize()) {}
+
+  std::mutex Mutex;
+  std::list<std::pair<Key, std::shared_ptr<CachedModule>>> LRU;
+  std::map<Key, decltype(LRU)::iterator> Index;
+  size_t Size = 0;
+  size_t Limit;
+};
+
+} // namespace
+
+static std::shared_ptr<CachedModule>
+getCachedModule(const ObjectFile &CodeObject,
+                const std::pair<uint64_t, size_t> &Key) {
+  SymbolizerCache &Cache = SymbolizerCache::get();
+  std::shared_ptr<CachedModule> Cached = Cache.lookup(Key);
+  statistics::recordCacheLookup(statistics::CK_Symbolizer, Cached != nullptr);
+  if (Cached) {
+    return Cached;
+  }
+
+  // Build the module without holding the cache lock, so that symbolizing a
+  // new code object does not block queries of cached ones.
+  auto Module = std::make_shared<CachedModule>();
+  Module->Buffer = llvm::MemoryBuffer::getMemBufferCopy(
+      CodeObject.getData(), CodeObject.getFileName());
+  auto ObjectOrErr = ObjectFile::createObjectFile(*Module->Buffer);
+  if (errorToBool(ObjectOrErr.takeError())) {
+    return Cache.insert(Key, std::make_shared<CachedModule>());
+  }
+  Module->Object = std::move(ObjectOrErr.get());
+
+  auto ModuleOrErr = SymbolizableObjectFile::create(
+      Module->Object.get(), llvm::DWARFContext::create(*Module->Object),
+      /*UntagAddresses=*/false);
+  if (errorToBool(ModuleOrErr.takeError())) {
+    return Cache.insert(Key, std::make_shared<CachedModule>());
+  }
+  Module->Module = std::move(ModuleOrErr.get());
+
+  return Cache.insert(Key, std::move(Module));
+}
+
 static llvm::symbolize::PrinterConfig getDefaultPrinterConfig() {
   llvm::symbolize::PrinterConfig Config;
   Config.Pretty = true;
@@ -69,7 +185,10 @@ static llvm::symbolize::ErrorHandler symbolize_error_handler(
 
 Symbolizer::Symbolizer(std::unique_ptr<ObjectFile> &&CodeObject,
                        PrintSymbolCallback PrintSymbol)
-    : CodeObject(std::move(CodeObject)), PrintSymbol(PrintSymbol) {}
+    : CodeObject(std::move(CodeObject)), PrintSymbol(PrintSymbol) {
+  llvm::StringRef Data = this->CodeObject->getData();
+  CacheKey = std::make_pair(llvm::xxHash64(Data), Data.size());
+}
 Symbolizer::~Symbolizer() = default;
 
 amd_comgr_status_t
@@ -105,14 +224,41 @@ amd_comgr_status_t Symbolizer::symbolize(uint64_t Address, bool IsCode,
   llvm::symbolize::Request Request{"", Address};
   auto Printer = std::make_unique<llvm::symbolize::LLVMPrinter>(OS, symbolize_error_handler(OS), Config);
 
+  // If the module cannot be built the address is reported as unknown, as
+  // llvm-symbolizer does.
+  std::shared_ptr<CachedModule> Module =
+      getCachedModule(*CodeObject, CacheKey);
+
+  // Match the default options of LLVMSymbolizer.
+  llvm::object::SectionedAddress ModuleOffset = {
+      Address, llvm::object::SectionedAddress::UndefSection};
   if (IsCode) {
-    auto ResOrErr = SymbolizerImpl.symbolizeInlinedCode(
-        *CodeObject, {Address, llvm::object::SectionedAddress::UndefSection});
-    Printer->print(Request, ResOrErr ? ResOrErr.get() : llvm::DIInliningInfo());
+    llvm::DIInliningInfo Info;
+    if (Module->Module) {
+      std::lock_guard<std::mutex> Lock(Module->Mutex);
+      Info = Module->Module->symbolizeInlinedCode(
+          ModuleOffset,
+          llvm::DILineInfoSpecifier(
+              llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+              llvm::DILineInfoSpecifier::FunctionNameKind::LinkageName),
+          /*UseSymbolTable=*/true);
+    }
+    if (Info.getNumberOfFrames() == 0) {
+      Info.addFrame(llvm::DILineInfo());
+    }
+    for (uint32_t I = 0, N = Info.getNumberOfFrames(); I < N; ++I) {
+      auto *Frame = Info.getMutableFrame(I);
+      Frame->FunctionName = llvm::demangle(Frame->FunctionName);
+    }
+    Printer->print(Request, Info);
   } else { // data
-    auto ResOrErr = SymbolizerImpl.symbolizeData(
-        *CodeObject, {Address, llvm::object::SectionedAddress::UndefSection});
-    Printer->print(Request, ResOrErr ? ResOrErr.get() : llvm::DIGlobal());
+    llvm::DIGlobal Global;
+    if (Module->Module) {
+      std::lock_guard<std::mutex> Lock(Module->Mutex);
+      Global = Module->Module->symbolizeData(ModuleOffset);
+    }
+    Global.Name = llvm::demangle(Global.Name);
+    Printer->print(Request, Global);
   }
 
   PrintSymbol(Result.c_str(), UserData);
@@ -44,6 +44,7 @@
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include <memory>
+#include <utility>
 
 using namespace llvm::symbolize;
 using namespace llvm::object;
@@ -81,10 +82,11 @@ struct Symbolizer {
   amd_comgr_status_t symbolize(uint64_t Address, bool IsCode, void *UserData);
 
 private:
-  // llvm symbolizer with default options
-  LLVMSymbolizer SymbolizerImpl;
   std::unique_ptr<ObjectFile> CodeObject;
   PrintSymbolCallback PrintSymbol;
+  // Content hash and size of CodeObject, which identify its entry in the
+  // process-wide cache of parsed debug information.
+  std::pair<uint64_t, size_t> CacheKey;
 };
 } // namespace COMGR
 #endif
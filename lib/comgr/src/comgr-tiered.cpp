@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-tiered.h"
+
+using namespace llvm;
+
+namespace COMGR {
+
+// The fast tier skips the optimization pipeline, including inlining, and
+// selects instructions at the lowest codegen optimization level. It comes
+// after the options of the user, so it overrides any -O option.
+static const char *FastTierOption = "-O0";
+
+bool TieredCompilation::isActionSupported(amd_comgr_action_kind_t ActionKind) {
+  switch (ActionKind) {
+  case AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC:
+  case AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC:
+  case AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE:
+  case AMD_COMGR_ACTION_CODEGEN_BC_TO_ASSEMBLY:
+    return true;
+  default:
+    return false;
+  }
+}
+
+amd_comgr_status_t
+TieredCompilation::create(amd_comgr_action_kind_t ActionKind,
+                          DataAction *ActionInfo,
+                          amd_comgr_data_set_t InputSet,
+                          amd_comgr_data_set_t ResultSet,
+                          amd_comgr_tiered_callback_t Callback, void *UserData,
+                          amd_comgr_tiered_compilation_t *CompilationT) {
+  DataAction FastInfo;
+  if (auto Status = FastInfo.copyFrom(*ActionInfo)) {
+    return Status;
+  }
+  if (auto Status = FastInfo.appendOption(FastTierOption)) {
+    return Status;
+  }
+  if (auto Status = amd_comgr_do_action(
+          ActionKind, DataAction::convert(&FastInfo), InputSet, ResultSet)) {
+    return Status;
+  }
+
+  std::unique_ptr<TieredCompilation> TC(
+      new (std::nothrow) TieredCompilation(ActionKind, Callback, UserData));
+  if (!TC) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+  if (auto Status = TC->OptimizedInfo.copyFrom(*ActionInfo)) {
+    return Status;
+  }
+  // The fast results are already usable, so nothing waits on the optimized
+  // tier.
+  TC->OptimizedInfo.Priority = AMD_COMGR_ACTION_PRIORITY_LOW;
+  if (auto Status = amd_comgr_create_data_set(&TC->InputSet)) {
+    return Status;
+  }
+  if (auto Status = amd_comgr_create_data_set(&TC->OptimizedSet)) {
+    return Status;
+  }
+  for (DataObject *Data : DataSet::convert(InputSet)->DataObjects) {
+    if (auto Status =
+            amd_comgr_data_set_add(TC->InputSet, DataObject::convert(Data))) {
+      return Status;
+    }
+  }
+
+  TC->Thread = std::thread(&TieredCompilation::runOptimizedTier, TC.get());
+  *CompilationT = convert(TC.release());
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+void TieredCompilation::runOptimizedTier() {
+  amd_comgr_status_t Status =
+      amd_comgr_do_action(ActionKind, DataAction::convert(&OptimizedInfo),
+                          InputSet, OptimizedSet);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Done = true;
+    OptimizedStatus = Status;
+  }
+  Finished.notify_all();
+
+  if (Callback) {
+    Callback(convert(this), Status, UserData);
+  }
+}
+
+TieredCompilation::~TieredCompilation() {
+  if (Thread.joinable()) {
+    Thread.join();
+  }
+  if (OptimizedSet.handle) {
+    amd_comgr_destroy_data_set(OptimizedSet);
+  }
+  if (InputSet.handle) {
+    amd_comgr_destroy_data_set(InputSet);
+  }
+}
+
+bool TieredCompilation::isDone() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Done;
+}
+
+amd_comgr_status_t TieredCompilation::wait(amd_comgr_data_set_t ResultSet) {
+  {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Finished.wait(Lock, [this] { return Done; });
+  }
+  if (OptimizedStatus != AMD_COMGR_STATUS_SUCCESS) {
+    return OptimizedStatus;
+  }
+  for (DataObject *Data : DataSet::convert(OptimizedSet)->DataObjects) {
+    if (auto Status =
+            amd_comgr_data_set_add(ResultSet, DataObject::convert(Data))) {
+      return Status;
+    }
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace COMGR
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef COMGR_TIERED_H
+#define COMGR_TIERED_H
+
+#include "comgr.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace COMGR {
+
+/// An action performed twice: once synchronously with minimal optimization,
+/// and once on a background thread with the options of the user.
+class TieredCompilation {
+  amd_comgr_action_kind_t ActionKind;
+  /// Snapshots of the action info and input of the user, which may be
+  /// changed or destroyed while the optimized tier runs.
+  DataAction OptimizedInfo;
+  amd_comgr_data_set_t InputSet = {0};
+  amd_comgr_data_set_t OptimizedSet = {0};
+  amd_comgr_tiered_callback_t Callback;
+  void *UserData;
+
+  std::mutex Mutex;
+  std::condition_variable Finished;
+  bool Done = false;
+  amd_comgr_status_t OptimizedStatus = AMD_COMGR_STATUS_ERROR;
+  std::thread Thread;
+
+  TieredCompilation(amd_comgr_action_kind_t ActionKind,
+                    amd_comgr_tiered_callback_t Callback, void *UserData)
+      : ActionKind(ActionKind), Callback(Callback), UserData(UserData) {}
+
+  void runOptimizedTier();
+
+public:
+  static amd_comgr_tiered_compilation_t convert(TieredCompilation *TC) {
+    amd_comgr_tiered_compilation_t Handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(TC))};
+    return Handle;
+  }
+
+  static TieredCompilation *convert(amd_comgr_tiered_compilation_t TC) {
+    return reinterpret_cast<TieredCompilation *>(TC.handle);
+  }
+
+  /// Whether tiered compilation supports \p ActionKind.
+  static bool isActionSupported(amd_comgr_action_kind_t ActionKind);
+
+  /// Perform the fast tier of \p ActionKind into \p ResultSet and, if it
+  /// succeeds, start the optimized tier.
+  static amd_comgr_status_t
+  create(amd_comgr_action_kind_t ActionKind, DataAction *ActionInfo,
+         amd_comgr_data_set_t InputSet, amd_comgr_data_set_t ResultSet,
+         amd_comgr_tiered_callback_t Callback, void *UserData,
+         amd_comgr_tiered_compilation_t *CompilationT);
+
+  ~TieredCompilation();
+
+  bool isDone();
+
+  /// Wait for the optimized tier, and add its results to \p ResultSet if it
+  /// succeeded. Return the status of the optimized tier.
+  amd_comgr_status_t wait(amd_comgr_data_set_t ResultSet);
+};
+
+} // namespace COMGR
+
+#endif // COMGR_TIERED_H
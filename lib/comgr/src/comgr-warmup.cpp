@@ -0,0 +1,173 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "comgr-warmup.h"
+#include "comgr-device-libs.h"
+#include "comgr.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/MC/TargetRegistry.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
+
+using namespace llvm;
+
+namespace COMGR {
+namespace warmup {
+
+namespace {
+
+// A warm-up thread, which sets Done as the last thing it does.
+struct WarmupThread {
+  std::thread Thread;
+  std::atomic<bool> Done{false};
+};
+
+// Warm-up threads may still run when the process exits. They check Cancelled
+// between steps, so joining them from the destructor only waits for the step
+// in progress. Finished threads are joined whenever a new one is started, so
+// that they do not hold on to their stacks until then.
+struct WarmupThreads {
+  std::mutex Mutex;
+  std::list<WarmupThread> Threads;
+  std::atomic<bool> Cancelled{false};
+
+  void joinFinished() {
+    for (auto It = Threads.begin(); It != Threads.end();) {
+      if (It->Done) {
+        It->Thread.join();
+        It = Threads.erase(It);
+      } else {
+        ++It;
+      }
+    }
+  }
+
+  ~WarmupThreads() {
+    Cancelled = true;
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (WarmupThread &Thread : Threads) {
+      if (Thread.Thread.joinable()) {
+        Thread.Thread.join();
+      }
+    }
+  }
+};
+
+WarmupThreads &getWarmupThreads() {
+  static WarmupThreads Threads;
+  return Threads;
+}
+
+// Build the MC layer objects every compilation and disassembly for the isa
+// constructs, which pages in the AMDGPU target code and its tables. They are
+// not kept: nothing in the actions could reuse them, as clang builds its own.
+void warmupTarget(StringRef IsaName) {
+  TargetIdentifier Ident;
+  if (parseTargetIdentifier(IsaName, Ident)) {
+    return;
+  }
+  std::string TT = (Twine(Ident.Arch) + "-" + Ident.Vendor + "-" + Ident.OS +
+                    "-" + Ident.Environ)
+                       .str();
+  SmallVector<std::string, 2> FeaturesVec;
+  for (auto &Feature : Ident.Features) {
+    FeaturesVec.push_back(
+        Twine(Feature.take_back() + Feature.drop_back()).str());
+  }
+  std::string Features = join(FeaturesVec, ",");
+
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget(TT, Error);
+  if (!TheTarget) {
+    return;
+  }
+  std::unique_ptr<const MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TT));
+  if (!MRI) {
+    return;
+  }
+  MCTargetOptions MCOptions;
+  std::unique_ptr<const MCAsmInfo> MAI(
+      TheTarget->createMCAsmInfo(*MRI, TT, MCOptions));
+  std::unique_ptr<const MCInstrInfo> MII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<const MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TT, Ident.Processor, Features));
+}
+
+void run(const std::vector<std::string> &IsaNames,
+         const std::vector<amd_comgr_language_t> &Languages,
+         const std::atomic<bool> &Cancelled) {
+  ensureLLVMInitialized();
+
+  for (amd_comgr_language_t Language : Languages) {
+    if (Cancelled) {
+      return;
+    }
+    prefetchDeviceLibraries(Language);
+  }
+
+  for (const std::string &IsaName : IsaNames) {
+    if (Cancelled) {
+      return;
+    }
+    warmupTarget(IsaName);
+  }
+}
+
+} // namespace
+
+amd_comgr_status_t start(std::vector<std::string> IsaNames,
+                         std::vector<amd_comgr_language_t> Languages) {
+  WarmupThreads &Threads = getWarmupThreads();
+  std::lock_guard<std::mutex> Lock(Threads.Mutex);
+  Threads.joinFinished();
+  WarmupThread &Thread = Threads.Threads.emplace_back();
+  Thread.Thread = std::thread(
+      [IsaNames = std::move(IsaNames), Languages = std::move(Languages),
+       &Cancelled = Threads.Cancelled, &Done = Thread.Done]() {
+        run(IsaNames, Languages, Cancelled);
+        Done = true;
+      });
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+} // namespace warmup
+} // namespace COMGR
@@ -34,15 +34,24 @@
  ******************************************************************************/
 
 #include "comgr.h"
+#include "comgr-analysis.h"
 #include "comgr-compiler.h"
 #include "comgr-device-libs.h"
 #include "comgr-disassembly.h"
 #include "comgr-env.h"
+#include "comgr-introspection.h"
+#include "comgr-load-image.h"
+#include "comgr-metadata-query.h"
 #include "comgr-metadata.h"
 #include "comgr-objdump.h"
+#include "comgr-pack.h"
+#include "comgr-scheduler.h"
 #include "comgr-signal.h"
+#include "comgr-statistics.h"
 #include "comgr-symbol.h"
 #include "comgr-symbolizer.h"
+#include "comgr-tiered.h"
+#include "comgr-warmup.h"
 
 #include "clang/Basic/Version.h"
 #include "llvm/Bitcode/BitcodeReader.h"
@@ -50,6 +59,7 @@
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/TargetSelect.h"
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 #include <string>
@@ -77,6 +87,16 @@ static bool isLanguageValid(amd_comgr_language_t Language) {
          Language <= AMD_COMGR_LANGUAGE_LAST;
 }
 
+static bool isDebugInfoModeValid(amd_comgr_debug_info_mode_t Mode) {
+  return Mode >= AMD_COMGR_DEBUG_INFO_MODE_KEEP &&
+         Mode <= AMD_COMGR_DEBUG_INFO_MODE_LAST;
+}
+
+static bool isActionPriorityValid(amd_comgr_action_priority_t Priority) {
+  return Priority >= AMD_COMGR_ACTION_PRIORITY_LOW &&
+         Priority <= AMD_COMGR_ACTION_PRIORITY_LAST;
+}
+
 static bool isActionValid(amd_comgr_action_kind_t ActionKind) {
   return ActionKind <= AMD_COMGR_ACTION_LAST;
 }
@@ -86,6 +106,26 @@ static bool isSymbolInfoValid(amd_comgr_symbol_info_t SymbolInfo) {
          SymbolInfo <= AMD_COMGR_SYMBOL_INFO_LAST;
 }
 
+static amd_comgr_status_t
+evaluateMetadataQuery(const MetadataQuery *Query, const DataMeta &Root,
+                      amd_comgr_metadata_node_t *Value) {
+  msgpack::DocNode Result;
+  if (!Query->evaluate(Root.DocNode, Result)) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  DataMeta *NewMetaP = new (std::nothrow) DataMeta();
+  if (!NewMetaP) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  NewMetaP->MetaDoc = Root.MetaDoc;
+  NewMetaP->DocNode = Result;
+  *Value = DataMeta::convert(NewMetaP);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 static amd_comgr_status_t
 dispatchDisassembleAction(amd_comgr_action_kind_t ActionKind,
                           DataAction *ActionInfo, DataSet *InputSet,
@@ -123,6 +163,14 @@ dispatchDisassembleAction(amd_comgr_action_kind_t ActionKind,
   Options.push_back((Twine("-mcpu=") + Ident.Processor).str());
   auto ActionOptions = ActionInfo->getOptions();
   Options.insert(Options.end(), ActionOptions.begin(), ActionOptions.end());
+  // Sources and includes in the input set annotate the disassembly with -S
+  for (auto *Input : InputSet->DataObjects) {
+    if (Input->DataKind == AMD_COMGR_DATA_KIND_SOURCE ||
+        Input->DataKind == AMD_COMGR_DATA_KIND_INCLUDE) {
+      Helper.addSourceFile(Input->Name ? Input->Name : "",
+                           StringRef(Input->Data, Input->Size));
+    }
+  }
   // Loop through the input data set, perform actions and add result
   // to output data set.
   for (auto *Input : Objects) {
@@ -154,10 +202,45 @@ dispatchDisassembleAction(amd_comgr_action_kind_t ActionKind,
 }
 
 static amd_comgr_status_t
-dispatchCompilerAction(amd_comgr_action_kind_t ActionKind,
+dispatchAnalysisAction(amd_comgr_action_kind_t ActionKind,
                        DataAction *ActionInfo, DataSet *InputSet,
-                       DataSet *ResultSet, raw_ostream &LogS) {
-  AMDGPUCompiler Compiler(ActionInfo, InputSet, ResultSet, LogS);
+                       DataSet *ResultSet) {
+  amd_comgr_data_set_t ResultSetT = DataSet::convert(ResultSet);
+
+  for (auto *Input : InputSet->DataObjects) {
+    if (Input->DataKind != AMD_COMGR_DATA_KIND_RELOCATABLE &&
+        Input->DataKind != AMD_COMGR_DATA_KIND_EXECUTABLE) {
+      continue;
+    }
+
+    std::string Report;
+    if (auto Status = analysis::analyzeInstructionMix(Input, Report)) {
+      return Status;
+    }
+
+    amd_comgr_data_t ResultT;
+    if (auto Status =
+            amd_comgr_create_data(AMD_COMGR_DATA_KIND_MSGPACK, &ResultT)) {
+      return Status;
+    }
+    ScopedDataObjectReleaser ResultSDOR(ResultT);
+    DataObject *Result = DataObject::convert(ResultT);
+    if (auto Status = Result->setName(std::string(Input->Name) + ".mix")) {
+      return Status;
+    }
+    if (auto Status = Result->setData(Report)) {
+      return Status;
+    }
+    if (auto Status = amd_comgr_data_set_add(ResultSetT, ResultT)) {
+      return Status;
+    }
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+static amd_comgr_status_t runCompilerAction(amd_comgr_action_kind_t ActionKind,
+                                            AMDGPUCompiler &Compiler) {
   switch (ActionKind) {
   case AMD_COMGR_ACTION_SOURCE_TO_PREPROCESSOR:
     return Compiler.preprocessToSource();
@@ -175,6 +258,8 @@ dispatchCompilerAction(amd_comgr_action_kind_t ActionKind,
     return Compiler.linkToRelocatable();
   case AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE:
     return Compiler.linkToExecutable();
+  case AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE:
+    return Compiler.linkBitcodeToExecutable();
   case AMD_COMGR_ACTION_COMPILE_SOURCE_TO_FATBIN:
     return Compiler.compileToFatBin();
   case AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC:
@@ -185,6 +270,20 @@ dispatchCompilerAction(amd_comgr_action_kind_t ActionKind,
   }
 }
 
+static amd_comgr_status_t
+dispatchCompilerAction(amd_comgr_action_kind_t ActionKind,
+                       DataAction *ActionInfo, DataSet *InputSet,
+                       DataSet *ResultSet, raw_ostream &LogS) {
+  AMDGPUCompiler Compiler(ActionInfo, InputSet, ResultSet, LogS);
+  amd_comgr_status_t ActionStatus = runCompilerAction(ActionKind, Compiler);
+  // Diagnostics are most useful when the action fails, so they are added
+  // regardless of its status.
+  if (auto Status = Compiler.addDiagnostics()) {
+    return Status;
+  }
+  return ActionStatus;
+}
+
 static amd_comgr_status_t dispatchAddAction(amd_comgr_action_kind_t ActionKind,
                                             DataAction *ActionInfo,
                                             DataSet *InputSet,
@@ -203,7 +302,7 @@ static amd_comgr_status_t dispatchAddAction(amd_comgr_action_kind_t ActionKind,
   }
 }
 
-StringRef getActionKindName(amd_comgr_action_kind_t ActionKind) {
+StringRef COMGR::getActionKindName(amd_comgr_action_kind_t ActionKind) {
   switch (ActionKind) {
   case AMD_COMGR_ACTION_SOURCE_TO_PREPROCESSOR:
     return "AMD_COMGR_ACTION_SOURCE_TO_PREPROCESSOR";
@@ -237,6 +336,10 @@ StringRef getActionKindName(amd_comgr_action_kind_t ActionKind) {
     return "AMD_COMGR_ACTION_COMPILE_SOURCE_TO_FATBIN";
   case AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC:
     return "AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC";
+  case AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX:
+    return "AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX";
+  case AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE:
+    return "AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE";
   default:
     return "UNKNOWN_ACTION_KIND";
   }
@@ -375,6 +478,7 @@ void COMGR::clearLLVMOptions() {
       O->setDefault();
     }
   }
+  statistics::restoreLLVMStatistics();
 }
 
 DataObject::DataObject(amd_comgr_data_kind_t DataKind)
@@ -434,9 +538,34 @@ DataSet::~DataSet() {
   }
 }
 
+static OptionSummary summarizeOptions(ArrayRef<std::string> Options) {
+  OptionSummary Summary;
+  for (auto &Option : Options) {
+    StringRef OptionRef(Option);
+    if (OptionRef.startswith("--rocm-path")) {
+      Summary.ROCmPath = true;
+    } else if (OptionRef.startswith("-std=") ||
+               OptionRef.startswith("--std=")) {
+      Summary.LanguageStandard = true;
+    } else if (OptionRef == "-fgpu-rdc") {
+      Summary.GPURelocatableDeviceCode = true;
+    } else if (OptionRef == "-fno-gpu-rdc") {
+      Summary.GPURelocatableDeviceCode = false;
+    } else if (OptionRef.startswith("-cuid=") ||
+               OptionRef.startswith("-fuse-cuid=")) {
+      Summary.CompilationUnitID = true;
+    }
+  }
+  return Summary;
+}
+
 DataAction::DataAction()
     : IsaName(nullptr), Path(nullptr), Language(AMD_COMGR_LANGUAGE_NONE),
-      Logging(false), AreOptionsList(false) {}
+      Logging(false), LLVMStatistics(false), StructuredDiagnostics(false),
+      DebugInfoMode(AMD_COMGR_DEBUG_INFO_MODE_KEEP),
+      Priority(AMD_COMGR_ACTION_PRIORITY_NORMAL), AreOptionsList(false),
+      Frozen(false), FrozenDeviceLibStatus(AMD_COMGR_STATUS_SUCCESS),
+      FrozenDeviceLibFlags(0) {}
 
 DataAction::~DataAction() {
   free(IsaName);
@@ -452,6 +581,9 @@ amd_comgr_status_t DataAction::setActionPath(llvm::StringRef ActionPath) {
 }
 
 amd_comgr_status_t DataAction::setOptionsFlat(StringRef Options) {
+  if (Frozen) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
   AreOptionsList = false;
   FlatOptions = Options.str();
   return AMD_COMGR_STATUS_SUCCESS;
@@ -466,6 +598,9 @@ amd_comgr_status_t DataAction::getOptionsFlat(StringRef &Options) {
 }
 
 amd_comgr_status_t DataAction::setOptionList(ArrayRef<const char *> Options) {
+  if (Frozen) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
   AreOptionsList = true;
   ListOptions.clear();
   for (auto &Option : Options) {
@@ -496,6 +631,11 @@ amd_comgr_status_t DataAction::getOptionListItem(size_t Index,
 }
 
 ArrayRef<std::string> DataAction::getOptions(bool IsDeviceLibs) {
+  if (Frozen) {
+    return IsDeviceLibs && !AreOptionsList ? FrozenDeviceLibOptions
+                                           : ListOptions;
+  }
+
   // In the legacy path the ListOptions is used as a buffer to split the
   // options in. We have to do this lazily as the delimiter depends on
   // IsDeviceLibs. We could avoid re-splitting in the case where the same call
@@ -517,6 +657,88 @@ ArrayRef<std::string> DataAction::getOptions(bool IsDeviceLibs) {
   return ListOptions;
 }
 
+amd_comgr_status_t DataAction::appendOption(StringRef Option) {
+  if (Frozen) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+  if (AreOptionsList) {
+    ListOptions.push_back(Option.str());
+  } else {
+    if (!FlatOptions.empty()) {
+      FlatOptions += ' ';
+    }
+    FlatOptions += Option;
+  }
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+OptionSummary DataAction::getOptionSummary() {
+  if (Frozen) {
+    return FrozenSummary;
+  }
+  return summarizeOptions(getOptions());
+}
+
+amd_comgr_status_t DataAction::getDeviceLibraryFlags(unsigned &Flags) {
+  if (Frozen) {
+    Flags = FrozenDeviceLibFlags;
+    return FrozenDeviceLibStatus;
+  }
+  return parseDeviceLibraryOptions(getOptions(true), Flags);
+}
+
+amd_comgr_status_t DataAction::freeze() {
+  if (Frozen) {
+    return AMD_COMGR_STATUS_SUCCESS;
+  }
+
+  if (IsaName) {
+    TargetIdentifier Ident;
+    if (parseTargetIdentifier(IsaName, Ident)) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  // The options are only known to be device library options when the action
+  // is performed, so an invalid device library option is not an error yet.
+  FrozenDeviceLibOptions = getOptions(true);
+  FrozenDeviceLibStatus =
+      parseDeviceLibraryOptions(FrozenDeviceLibOptions, FrozenDeviceLibFlags);
+  // Leaves ListOptions split for the other actions.
+  FrozenSummary = summarizeOptions(getOptions());
+  Frozen = true;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t DataAction::copyFrom(const DataAction &Other) {
+  if (Frozen) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+  if (Other.IsaName) {
+    if (auto Status = setIsaName(Other.IsaName)) {
+      return Status;
+    }
+  }
+  if (Other.Path) {
+    if (auto Status = setActionPath(Other.Path)) {
+      return Status;
+    }
+  }
+  Language = Other.Language;
+  Logging = Other.Logging;
+  LLVMStatistics = Other.LLVMStatistics;
+  StructuredDiagnostics = Other.StructuredDiagnostics;
+  DebugInfoMode = Other.DebugInfoMode;
+  Priority = Other.Priority;
+  KernelRoots = Other.KernelRoots;
+  FunctionOrder = Other.FunctionOrder;
+  AreOptionsList = Other.AreOptionsList;
+  FlatOptions = Other.FlatOptions;
+  ListOptions = Other.ListOptions;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_metadata_kind_t DataMeta::getMetadataKind() {
   if (DocNode.isScalar()) {
     return AMD_COMGR_METADATA_KIND_STRING;
@@ -775,6 +997,7 @@ amd_comgr_status_t AMD_COMGR_API
   if (!CodeObjectP || !PrintSymbolCallback ||
       !(CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_RELOCATABLE ||
         CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_EXECUTABLE ||
+        CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_DEBUG_INFO ||
         CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_BYTES))
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
 
@@ -813,6 +1036,247 @@ amd_comgr_status_t AMD_COMGR_API
   return SI->symbolize(Address, IsCode, UserData);
 }
 
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_create_cfg_info
+    //
+    (amd_comgr_data_t CodeObject, amd_comgr_cfg_info_t *CFGInfoT) {
+
+  DataObject *CodeObjectP = DataObject::convert(CodeObject);
+  if (!CodeObjectP || !CFGInfoT ||
+      !(CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_RELOCATABLE ||
+        CodeObjectP->DataKind == AMD_COMGR_DATA_KIND_EXECUTABLE))
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+
+  ensureLLVMInitialized();
+
+  return CFGInfo::create(CodeObjectP, CFGInfoT);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_destroy_cfg_info
+    //
+    (amd_comgr_cfg_info_t CFGInfoT) {
+
+  CFGInfo *CFG = CFGInfo::convert(CFGInfoT);
+  if (!CFG) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  delete CFG;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_cfg_function_count
+    //
+    (amd_comgr_cfg_info_t CFGInfoT, size_t *Count) {
+
+  CFGInfo *CFG = CFGInfo::convert(CFGInfoT);
+  if (!CFG || !Count) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Count = CFG->Functions.size();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_cfg_function
+    //
+    (amd_comgr_cfg_info_t CFGInfoT, size_t Index,
+     amd_comgr_cfg_function_t *Function) {
+
+  CFGInfo *CFG = CFGInfo::convert(CFGInfoT);
+  if (!CFG || Index >= CFG->Functions.size() || !Function) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const CFGFunction &F = CFG->Functions[Index];
+  Function->name = F.Name.c_str();
+  Function->address = F.Address;
+  Function->size = F.Size;
+  Function->block_count = F.Blocks.size();
+  Function->blocks = F.Blocks.data();
+  Function->edge_count = F.Edges.size();
+  Function->edges = F.Edges.data();
+  Function->call_count = F.Calls.size();
+  Function->calls = F.Calls.data();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_create_introspection_info
+    //
+    (amd_comgr_data_set_t Set, uint32_t Facts, size_t ThreadCount,
+     amd_comgr_introspection_info_t *InfoT) {
+
+  DataSet *SetP = DataSet::convert(Set);
+  if (!SetP || !InfoT || !Facts ||
+      (Facts & ~uint32_t(AMD_COMGR_INTROSPECTION_FACT_ALL))) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  ensureLLVMInitialized();
+
+  return IntrospectionInfo::create(SetP, Facts, ThreadCount, InfoT);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_destroy_introspection_info
+    //
+    (amd_comgr_introspection_info_t InfoT) {
+
+  IntrospectionInfo *Info = IntrospectionInfo::convert(InfoT);
+  if (!Info) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  delete Info;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_introspection_result_count
+    //
+    (amd_comgr_introspection_info_t InfoT, size_t *Count) {
+
+  IntrospectionInfo *Info = IntrospectionInfo::convert(InfoT);
+  if (!Info || !Count) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Count = Info->Results.size();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_introspection_result
+    //
+    (amd_comgr_introspection_info_t InfoT, size_t Index,
+     amd_comgr_introspection_result_t *Result) {
+
+  IntrospectionInfo *Info = IntrospectionInfo::convert(InfoT);
+  if (!Info || Index >= Info->Results.size() || !Result) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const IntrospectionResult &R = Info->Results[Index];
+  Result->data = DataObject::convert(R.Data);
+  Result->status = R.Status;
+  Result->isa_name = R.IsaName.empty() ? nullptr : R.IsaName.c_str();
+  Result->metadata = {0};
+  if (R.Metadata) {
+    Result->metadata = DataMeta::convert(R.Metadata.get());
+  }
+  Result->symbol_count = R.Symbols.size();
+  Result->symbols = R.Symbols.data();
+  Result->kernel_count = R.Kernels.size();
+  Result->kernel_names = R.Kernels.data();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_create_load_image
+    //
+    (amd_comgr_data_t Executable, uint64_t LoadBase, amd_comgr_data_t *Image) {
+
+  DataObject *ExecutableP = DataObject::convert(Executable);
+  if (!ExecutableP || !ExecutableP->Data || !Image ||
+      ExecutableP->DataKind != AMD_COMGR_DATA_KIND_EXECUTABLE) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::string Blob;
+  if (auto Status = loadimage::createLoadImage(ExecutableP, LoadBase, Blob)) {
+    return Status;
+  }
+
+  amd_comgr_data_t ImageT;
+  if (auto Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_BYTES, &ImageT)) {
+    return Status;
+  }
+  if (auto Status = DataObject::convert(ImageT)->setData(Blob)) {
+    amd_comgr_release_data(ImageT);
+    return Status;
+  }
+
+  *Image = ImageT;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_statistics
+    //
+    (amd_comgr_data_t *Statistics) {
+  if (!Statistics) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::string Blob;
+  statistics::getStatistics(Blob);
+
+  amd_comgr_data_t StatisticsT;
+  if (auto Status =
+          amd_comgr_create_data(AMD_COMGR_DATA_KIND_MSGPACK, &StatisticsT)) {
+    return Status;
+  }
+  if (auto Status = DataObject::convert(StatisticsT)->setData(Blob)) {
+    amd_comgr_release_data(StatisticsT);
+    return Status;
+  }
+
+  *Statistics = StatisticsT;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_reset_statistics
+    //
+    () {
+  statistics::resetStatistics();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_warmup
+    //
+    (size_t IsaCount, const char **IsaNames, size_t LanguageCount,
+     const amd_comgr_language_t *Languages) {
+  if ((IsaCount && !IsaNames) || (LanguageCount && !Languages)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::vector<std::string> IsaNameList;
+  for (size_t I = 0; I < IsaCount; ++I) {
+    if (!IsaNames[I] || !metadata::isValidIsaName(IsaNames[I])) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    IsaNameList.push_back(IsaNames[I]);
+  }
+
+  std::vector<amd_comgr_language_t> LanguageList;
+  for (size_t I = 0; I < LanguageCount; ++I) {
+    if (!isLanguageValid(Languages[I])) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    LanguageList.push_back(Languages[I]);
+  }
+
+  return warmup::start(std::move(IsaNameList), std::move(LanguageList));
+}
+
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
     amd_comgr_get_data_isa_name
@@ -979,16 +1443,67 @@ amd_comgr_status_t AMD_COMGR_API
 
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
-    amd_comgr_create_action_info
+    amd_comgr_pack_data_set
     //
-    (amd_comgr_action_info_t *ActionInfo) {
-  if (!ActionInfo) {
+    (amd_comgr_data_set_t Set, amd_comgr_data_t *Packed) {
+  DataSet *SetP = DataSet::convert(Set);
+
+  if (!SetP || !Packed) {
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
-  DataAction *ActionP = new (std::nothrow) DataAction();
-  if (!ActionP) {
-    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+  std::string Blob;
+  if (auto Status = pack::packDataSet(SetP, Blob)) {
+    return Status;
+  }
+
+  amd_comgr_data_t PackedT;
+  if (auto Status =
+          amd_comgr_create_data(AMD_COMGR_DATA_KIND_BYTES, &PackedT)) {
+    return Status;
+  }
+  if (auto Status = DataObject::convert(PackedT)->setData(Blob)) {
+    amd_comgr_release_data(PackedT);
+    return Status;
+  }
+
+  *Packed = PackedT;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_unpack_data_set
+    //
+    (int FD, uint64_t Offset, uint64_t Size, amd_comgr_data_set_t Set) {
+  DataSet *SetP = DataSet::convert(Set);
+
+  if (!SetP) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  auto FileHandle = sys::fs::convertFDToNativeFile(FD);
+  auto BufferOrErr = MemoryBuffer::getOpenFileSlice(
+      FileHandle, "" /* Name not set */, Size, Offset);
+  if (BufferOrErr.getError()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  return pack::unpackDataSet(std::move(*BufferOrErr), SetP);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_create_action_info
+    //
+    (amd_comgr_action_info_t *ActionInfo) {
+  if (!ActionInfo) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  DataAction *ActionP = new (std::nothrow) DataAction();
+  if (!ActionP) {
+    return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
   *ActionInfo = DataAction::convert(ActionP);
@@ -1023,6 +1538,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   if (!IsaName || StringRef(IsaName) == "") {
     free(ActionP->IsaName);
     ActionP->IsaName = nullptr;
@@ -1067,6 +1586,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   ActionP->Language = Language;
 
   return AMD_COMGR_STATUS_SUCCESS;
@@ -1099,6 +1622,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   return ActionP->setOptionsFlat(Options);
 }
 
@@ -1138,6 +1665,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   return ActionP->setOptionList(ArrayRef<const char *>(Options, Count));
 }
 
@@ -1192,6 +1723,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   ActionP->setActionPath(Path);
 
   return AMD_COMGR_STATUS_SUCCESS;
@@ -1228,6 +1763,10 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
   ActionP->Logging = Logging;
 
   return AMD_COMGR_STATUS_SUCCESS;
@@ -1249,6 +1788,300 @@ amd_comgr_status_t AMD_COMGR_API
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_llvm_statistics
+    //
+    (amd_comgr_action_info_t ActionInfo, bool LLVMStatistics) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->LLVMStatistics = LLVMStatistics;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_llvm_statistics
+    //
+    (amd_comgr_action_info_t ActionInfo, bool *LLVMStatistics) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !LLVMStatistics) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *LLVMStatistics = ActionP->LLVMStatistics;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_structured_diagnostics
+    //
+    (amd_comgr_action_info_t ActionInfo, bool StructuredDiagnostics) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->StructuredDiagnostics = StructuredDiagnostics;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_structured_diagnostics
+    //
+    (amd_comgr_action_info_t ActionInfo, bool *StructuredDiagnostics) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !StructuredDiagnostics) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *StructuredDiagnostics = ActionP->StructuredDiagnostics;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_debug_info_mode
+    //
+    (amd_comgr_action_info_t ActionInfo, amd_comgr_debug_info_mode_t Mode) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !isDebugInfoModeValid(Mode)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->DebugInfoMode = Mode;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_debug_info_mode
+    //
+    (amd_comgr_action_info_t ActionInfo, amd_comgr_debug_info_mode_t *Mode) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Mode) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Mode = ActionP->DebugInfoMode;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_priority
+    //
+    (amd_comgr_action_info_t ActionInfo,
+     amd_comgr_action_priority_t Priority) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !isActionPriorityValid(Priority)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->Priority = Priority;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_priority
+    //
+    (amd_comgr_action_info_t ActionInfo,
+     amd_comgr_action_priority_t *Priority) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Priority) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Priority = ActionP->Priority;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_kernel_root_list
+    //
+    (amd_comgr_action_info_t ActionInfo, const char *KernelNames[],
+     size_t Count) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || (!KernelNames && Count)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->KernelRoots.assign(KernelNames, KernelNames + Count);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_kernel_root_list_count
+    //
+    (amd_comgr_action_info_t ActionInfo, size_t *Count) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Count) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Count = ActionP->KernelRoots.size();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_kernel_root_list_item
+    //
+    (amd_comgr_action_info_t ActionInfo, size_t Index, size_t *Size,
+     char *KernelName) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Size || Index >= ActionP->KernelRoots.size()) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const std::string &Root = ActionP->KernelRoots[Index];
+  if (KernelName) {
+    memcpy(KernelName, Root.c_str(), *Size);
+  } else {
+    *Size = Root.size() + 1;
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_set_function_order_list
+    //
+    (amd_comgr_action_info_t ActionInfo, const char *FunctionNames[],
+     size_t Count) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || (!FunctionNames && Count)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (ActionP->isFrozen()) {
+    return AMD_COMGR_STATUS_ERROR;
+  }
+
+  ActionP->FunctionOrder.assign(FunctionNames, FunctionNames + Count);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_function_order_list_count
+    //
+    (amd_comgr_action_info_t ActionInfo, size_t *Count) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Count) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Count = ActionP->FunctionOrder.size();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_get_function_order_list_item
+    //
+    (amd_comgr_action_info_t ActionInfo, size_t Index, size_t *Size,
+     char *FunctionName) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Size || Index >= ActionP->FunctionOrder.size()) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const std::string &Name = ActionP->FunctionOrder[Index];
+  if (FunctionName) {
+    memcpy(FunctionName, Name.c_str(), *Size);
+  } else {
+    *Size = Name.size() + 1;
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_freeze
+    //
+    (amd_comgr_action_info_t ActionInfo) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return ActionP->freeze();
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_action_info_is_frozen
+    //
+    (amd_comgr_action_info_t ActionInfo, bool *Frozen) {
+  DataAction *ActionP = DataAction::convert(ActionInfo);
+
+  if (!ActionP || !Frozen) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Frozen = ActionP->isFrozen();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
     amd_comgr_do_action
@@ -1267,11 +2100,10 @@ amd_comgr_status_t AMD_COMGR_API
 
   // Enclose core Comgr actions in a mutally excusive region to avoid
   // multithreading issues stemming from concurrently maintaing multiple
-  // LLVM instances.
-  // TODO: Remove the scoped lock once updates to LLVM enable thread saftey
-  static std::mutex comgr_mutex;
+  // LLVM instances. Waiting actions are admitted in order of priority.
+  // TODO: Remove the admission once updates to LLVM enable thread saftey
   {
-    std::scoped_lock comgr_lock(comgr_mutex);
+    scheduler::ScopedAdmission Admission(ActionInfoP->Priority);
 
     ensureLLVMInitialized();
 
@@ -1336,6 +2168,14 @@ amd_comgr_status_t AMD_COMGR_API
     }
 
 
+    uint64_t BytesIn = 0;
+    for (DataObject *Data : InputSetP->DataObjects) {
+      BytesIn += Data->Size;
+    }
+    size_t ResultCount = ResultSetP->DataObjects.size();
+
+    statistics::LLVMStatisticsScope LLVMStatistics(ActionInfoP->LLVMStatistics);
+
     ProfilePoint ProfileAction(getActionKindName(ActionKind));
     switch (ActionKind) {
     case AMD_COMGR_ACTION_DISASSEMBLE_RELOCATABLE_TO_SOURCE:
@@ -1354,6 +2194,7 @@ amd_comgr_status_t AMD_COMGR_API
     case AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE:
     case AMD_COMGR_ACTION_COMPILE_SOURCE_TO_FATBIN:
     case AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC:
+    case AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE:
       ActionStatus = dispatchCompilerAction(ActionKind, ActionInfoP, InputSetP,
                                             ResultSetP, *LogP);
       break;
@@ -1362,11 +2203,21 @@ amd_comgr_status_t AMD_COMGR_API
       ActionStatus =
         dispatchAddAction(ActionKind, ActionInfoP, InputSetP, ResultSetP);
       break;
+    case AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX:
+      ActionStatus =
+        dispatchAnalysisAction(ActionKind, ActionInfoP, InputSetP, ResultSetP);
+      break;
     default:
       ActionStatus = AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
     }
     ProfileAction.finish();
 
+    uint64_t BytesOut = 0;
+    for (size_t I = ResultCount; I < ResultSetP->DataObjects.size(); ++I) {
+      BytesOut += ResultSetP->DataObjects[I]->Size;
+    }
+    statistics::recordAction(ActionKind, ActionStatus, BytesIn, BytesOut);
+
     // Restore signal handlers.
     if (auto Status = signal::restoreHandlers()) {
       return Status;
@@ -1393,11 +2244,98 @@ amd_comgr_status_t AMD_COMGR_API
         return Status;
       }
     }
-  } // exit scoped_lock region
+
+    if (ActionInfoP->LLVMStatistics) {
+      std::string Blob;
+      LLVMStatistics.finish(Blob);
+
+      amd_comgr_data_t StatsT;
+      if (auto Status =
+              amd_comgr_create_data(AMD_COMGR_DATA_KIND_MSGPACK, &StatsT)) {
+        return Status;
+      }
+      ScopedDataObjectReleaser StatsSDOR(StatsT);
+      DataObject *Stats = DataObject::convert(StatsT);
+      if (auto Status = Stats->setName("llvm-statistics")) {
+        return Status;
+      }
+      if (auto Status = Stats->setData(Blob)) {
+        return Status;
+      }
+      if (auto Status = amd_comgr_data_set_add(ResultSet, StatsT)) {
+        return Status;
+      }
+    }
+  } // exit admission region
 
   return ActionStatus;
 }
 
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_do_action_tiered
+    //
+    (amd_comgr_action_kind_t ActionKind, amd_comgr_action_info_t ActionInfo,
+     amd_comgr_data_set_t InputSet, amd_comgr_data_set_t ResultSet,
+     amd_comgr_tiered_callback_t Callback, void *UserData,
+     amd_comgr_tiered_compilation_t *Compilation) {
+  DataAction *ActionInfoP = DataAction::convert(ActionInfo);
+
+  if (!TieredCompilation::isActionSupported(ActionKind) || !ActionInfoP ||
+      !DataSet::convert(InputSet) || !DataSet::convert(ResultSet) ||
+      !Compilation) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return TieredCompilation::create(ActionKind, ActionInfoP, InputSet,
+                                   ResultSet, Callback, UserData, Compilation);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_tiered_compilation_is_done
+    //
+    (amd_comgr_tiered_compilation_t Compilation, bool *Done) {
+  TieredCompilation *TC = TieredCompilation::convert(Compilation);
+
+  if (!TC || !Done) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Done = TC->isDone();
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_tiered_compilation_wait
+    //
+    (amd_comgr_tiered_compilation_t Compilation,
+     amd_comgr_data_set_t ResultSet) {
+  TieredCompilation *TC = TieredCompilation::convert(Compilation);
+
+  if (!TC || !DataSet::convert(ResultSet)) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return TC->wait(ResultSet);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_destroy_tiered_compilation
+    //
+    (amd_comgr_tiered_compilation_t Compilation) {
+  TieredCompilation *TC = TieredCompilation::convert(Compilation);
+
+  if (!TC) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  delete TC;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
     amd_comgr_get_data_metadata
@@ -1473,10 +2411,23 @@ amd_comgr_status_t AMD_COMGR_API
     return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
-  std::string Str = MetaP->convertDocNodeToString(MetaP->DocNode);
+  // String nodes reference the retained document, so only other scalars need
+  // to be formatted.
+  std::string Storage;
+  StringRef Str;
+  if (MetaP->DocNode.getKind() == msgpack::Type::String) {
+    Str = MetaP->DocNode.getString();
+  } else {
+    Storage = MetaP->convertDocNodeToString(MetaP->DocNode);
+    Str = Storage;
+  }
 
   if (String) {
-    memcpy(String, Str.c_str(), *Size);
+    size_t CopySize = std::min(*Size, Str.size());
+    memcpy(String, Str.data(), CopySize);
+    if (*Size > Str.size()) {
+      String[Str.size()] = '\0';
+    }
   } else {
     *Size = Str.size() + 1;
   }
@@ -1484,6 +2435,67 @@ amd_comgr_status_t AMD_COMGR_API
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_metadata_string_view
+    //
+    (amd_comgr_metadata_node_t MetadataNode, const char **String,
+     size_t *Size) {
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (MetaP->DocNode.getKind() != msgpack::Type::String || !String || !Size) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  StringRef Str = MetaP->DocNode.getString();
+  *String = Str.data();
+  *Size = Str.size();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_metadata_uint64
+    //
+    (amd_comgr_metadata_node_t MetadataNode, uint64_t *Value) {
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (!Value) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  switch (MetaP->DocNode.getKind()) {
+  case msgpack::Type::UInt:
+    *Value = MetaP->DocNode.getUInt();
+    return AMD_COMGR_STATUS_SUCCESS;
+  case msgpack::Type::Int:
+    if (MetaP->DocNode.getInt() < 0) {
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    *Value = MetaP->DocNode.getInt();
+    return AMD_COMGR_STATUS_SUCCESS;
+  default:
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_get_metadata_bool
+    //
+    (amd_comgr_metadata_node_t MetadataNode, bool *Value) {
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (MetaP->DocNode.getKind() != msgpack::Type::Boolean || !Value) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  *Value = MetaP->DocNode.getBool();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
     amd_comgr_get_metadata_map_size
@@ -1516,21 +2528,19 @@ amd_comgr_status_t AMD_COMGR_API
 
   auto Map = MetaP->DocNode.getMap();
 
+  // The nodes passed to the callback are only valid until it returns, so they
+  // can live on the stack rather than be allocated for every entry.
+  DataMeta Key, Value;
+  Key.MetaDoc = MetaP->MetaDoc;
+  Value.MetaDoc = MetaP->MetaDoc;
+
   for (auto &KV : Map) {
     if (KV.first.isEmpty() || KV.second.isEmpty()) {
       return AMD_COMGR_STATUS_ERROR;
     }
-    std::unique_ptr<DataMeta> KeyP(new (std::nothrow) DataMeta());
-    std::unique_ptr<DataMeta> ValueP(new (std::nothrow) DataMeta());
-    if (!KeyP || !ValueP) {
-      return AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
-    }
-    KeyP->MetaDoc = MetaP->MetaDoc;
-    KeyP->DocNode = KV.first;
-    ValueP->MetaDoc = MetaP->MetaDoc;
-    ValueP->DocNode = KV.second;
-    (*Callback)(DataMeta::convert(KeyP.get()), DataMeta::convert(ValueP.get()),
-                UserData);
+    Key.DocNode = KV.first;
+    Value.DocNode = KV.second;
+    (*Callback)(DataMeta::convert(&Key), DataMeta::convert(&Value), UserData);
   }
 
   return AMD_COMGR_STATUS_SUCCESS;
@@ -1550,8 +2560,12 @@ amd_comgr_status_t AMD_COMGR_API
   }
 
   for (auto Iter : MetaP->DocNode.getMap()) {
-    if (!Iter.first.isScalar() ||
-        StringRef(Key) != MetaP->convertDocNodeToString(Iter.first)) {
+    if (!Iter.first.isScalar()) {
+      continue;
+    }
+    if (Iter.first.getKind() == msgpack::Type::String
+            ? Iter.first.getString() != Key
+            : StringRef(Key) != MetaP->convertDocNodeToString(Iter.first)) {
       continue;
     }
 
@@ -1616,6 +2630,161 @@ amd_comgr_status_t AMD_COMGR_API
   return AMD_COMGR_STATUS_SUCCESS;
 }
 
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_create_metadata_query
+    //
+    (const char *Path, amd_comgr_metadata_query_t *Query) {
+  if (!Path || !Query) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  MetadataQuery *QueryP;
+  if (auto Status = MetadataQuery::create(Path, QueryP)) {
+    return Status;
+  }
+
+  *Query = MetadataQuery::convert(QueryP);
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_destroy_metadata_query
+    //
+    (amd_comgr_metadata_query_t Query) {
+  MetadataQuery *QueryP = MetadataQuery::convert(Query);
+
+  if (!QueryP) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  delete QueryP;
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_evaluate_metadata_query
+    //
+    (amd_comgr_metadata_query_t Query, amd_comgr_metadata_node_t MetadataNode,
+     amd_comgr_metadata_node_t *Value) {
+  MetadataQuery *QueryP = MetadataQuery::convert(Query);
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (!QueryP || !MetaP || !Value) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return evaluateMetadataQuery(QueryP, *MetaP, Value);
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_evaluate_metadata_query_batch
+    //
+    (amd_comgr_metadata_query_t Query, size_t Count,
+     const amd_comgr_data_t *Data, amd_comgr_metadata_node_t *Values,
+     amd_comgr_status_t *Statuses) {
+  MetadataQuery *QueryP = MetadataQuery::convert(Query);
+
+  if (!QueryP || (Count && (!Data || !Values || !Statuses))) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (size_t I = 0; I < Count; ++I) {
+    DataObject *DataP = DataObject::convert(Data[I]);
+    if (!DataP || !DataP->hasValidDataKind() ||
+        DataP->DataKind == AMD_COMGR_DATA_KIND_UNDEF) {
+      Statuses[I] = AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+      continue;
+    }
+
+    // The root only lives for this iteration; the selected node keeps the
+    // document alive.
+    DataMeta Root;
+    Root.MetaDoc.reset(new (std::nothrow) MetaDocument());
+    if (!Root.MetaDoc) {
+      Statuses[I] = AMD_COMGR_STATUS_ERROR_OUT_OF_RESOURCES;
+      continue;
+    }
+    Root.DocNode = Root.MetaDoc->Document.getRoot();
+
+    if (auto Status = metadata::getMetadataRoot(DataP, &Root)) {
+      Statuses[I] = Status;
+      continue;
+    }
+
+    Statuses[I] = evaluateMetadataQuery(QueryP, Root, &Values[I]);
+  }
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_export_metadata
+    //
+    (amd_comgr_metadata_node_t MetadataNode,
+     amd_comgr_metadata_format_t Format, size_t *Size, char *Buffer) {
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (!MetaP || !Size) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::string Blob;
+  if (auto Status = metadata::exportMetadata(MetaP->DocNode, Format, Blob)) {
+    return Status;
+  }
+
+  if (Buffer) {
+    if (*Size < Blob.size()) {
+      *Size = Blob.size();
+      return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    memcpy(Buffer, Blob.data(), Blob.size());
+  }
+  *Size = Blob.size();
+
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_export_metadata_to_data
+    //
+    (amd_comgr_metadata_node_t MetadataNode,
+     amd_comgr_metadata_format_t Format, amd_comgr_data_t *Data) {
+  DataMeta *MetaP = DataMeta::convert(MetadataNode);
+
+  if (!MetaP || !Data) {
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::string Blob;
+  if (auto Status = metadata::exportMetadata(MetaP->DocNode, Format, Blob)) {
+    return Status;
+  }
+
+  amd_comgr_data_kind_t Kind = Format == AMD_COMGR_METADATA_FORMAT_MSGPACK
+                                   ? AMD_COMGR_DATA_KIND_MSGPACK
+                                   : AMD_COMGR_DATA_KIND_BYTES;
+  amd_comgr_data_t DataT;
+  if (auto Status = amd_comgr_create_data(Kind, &DataT)) {
+    return Status;
+  }
+  if (auto Status = DataObject::convert(DataT)->setData(Blob)) {
+    amd_comgr_release_data(DataT);
+    return Status;
+  }
+
+  *Data = DataT;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
 amd_comgr_status_t AMD_COMGR_API
     // NOLINTNEXTLINE(readability-identifier-naming)
     amd_comgr_iterate_symbols
@@ -1940,3 +3109,16 @@ amd_comgr_status_t AMD_COMGR_API
 
   return metadata::lookUpCodeObject(DataP, QueryList, QueryListSize);
 }
+
+amd_comgr_status_t AMD_COMGR_API
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    amd_comgr_lookup_code_object_from_file
+    //
+    (int FD, uint64_t Offset, uint64_t Size,
+     amd_comgr_code_object_info_t *QueryList, size_t QueryListSize) {
+  if (FD < 0 || !Size || !QueryList)
+    return AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT;
+
+  return metadata::lookUpCodeObjectFromFile(FD, Offset, Size, QueryList,
+                                            QueryListSize);
+}
@@ -91,6 +91,9 @@ void clearLLVMOptions();
 /// Return `true` if the kind is valid, or false otherwise.
 bool isDataKindValid(amd_comgr_data_kind_t DataKind);
 
+/// Return the name of an action kind, as spelled in the API.
+llvm::StringRef getActionKindName(amd_comgr_action_kind_t ActionKind);
+
 struct DataObject {
 
   // Allocate a new DataObject and return a pointer to it.
@@ -182,6 +185,18 @@ struct DataSet {
   llvm::SmallSetVector<DataObject *, 8> DataObjects;
 };
 
+// Properties of the options of an action info which several actions look up.
+struct OptionSummary {
+  // --rocm-path was given, so Clang may link the device libraries.
+  bool ROCmPath = false;
+  // A language standard was given with -std=.
+  bool LanguageStandard = false;
+  // The last of -fgpu-rdc and -fno-gpu-rdc requests relocatable device code.
+  bool GPURelocatableDeviceCode = false;
+  // A compilation unit ID was given with -cuid= or -fuse-cuid=.
+  bool CompilationUnitID = false;
+};
+
 struct DataAction {
   // Some actions involving llvm we want to do it only once for the entire
   // duration of the COMGR library. Once initialized, they should never be
@@ -229,15 +244,51 @@ struct DataAction {
   // as no other option APIs are called.
   llvm::ArrayRef<std::string> getOptions(bool IsDeviceLibs = false);
 
+  // Append an option to the options, in whichever form they were set.
+  amd_comgr_status_t appendOption(llvm::StringRef Option);
+
+  // Return the properties of the options which several actions look up.
+  OptionSummary getOptionSummary();
+
+  // Parse the options as AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES options into a
+  // bitmask of DeviceLibraryFlag.
+  amd_comgr_status_t getDeviceLibraryFlags(unsigned &Flags);
+
+  // Validate the settings and parse the options once, so that the getters
+  // above only return the parsed forms. A frozen action info can no longer
+  // be modified, and the references returned by getOptions() remain valid.
+  amd_comgr_status_t freeze();
+  bool isFrozen() const { return Frozen; }
+
+  // Replace every setting and option with those of Other. The copy is not
+  // frozen, even if Other is.
+  amd_comgr_status_t copyFrom(const DataAction &Other);
+
   char *IsaName;
   char *Path;
   amd_comgr_language_t Language;
   bool Logging;
+  bool LLVMStatistics;
+  bool StructuredDiagnostics;
+  amd_comgr_debug_info_mode_t DebugInfoMode;
+  amd_comgr_action_priority_t Priority;
+  // Kernels to keep when eliminating unused kernels. Empty if disabled.
+  std::vector<std::string> KernelRoots;
+  // Functions to lay out first in the code object, hottest first. Empty if
+  // disabled.
+  std::vector<std::string> FunctionOrder;
 
 private:
   bool AreOptionsList;
   std::string FlatOptions;
   std::vector<std::string> ListOptions;
+
+  // The options parsed by freeze().
+  bool Frozen;
+  std::vector<std::string> FrozenDeviceLibOptions;
+  OptionSummary FrozenSummary;
+  amd_comgr_status_t FrozenDeviceLibStatus;
+  unsigned FrozenDeviceLibFlags;
 };
 
 // Elements common to all DataMeta which refer to the same "document".
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -10,12 +11,6 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 
-#if defined _WIN64 || defined _WIN32
-#include <windows.h>
-#elif defined __linux__
-#include <time.h>
-#endif
-
 using namespace llvm;
 using namespace COMGR;
 
@@ -24,9 +19,14 @@ using namespace COMGR;
 
 namespace TimeStatistics {
 
-static std::unique_ptr<PerfStats> PS = nullptr;
+// Never destroyed, so that threads exiting during process exit can still
+// retire their counters.
+static PerfStats *PS = nullptr;
+static std::mutex InitMutex;
 static void dump() { PS->dumpPerfStats(); }
 
+std::atomic<bool> Enabled(false);
+
 void GetLogFile(std::string &PerfLog) {
   if (std::optional<StringRef> RedirectLogs = env::getRedirectLogs()) {
     PerfLog = (*RedirectLogs).str();
@@ -36,126 +36,77 @@ void GetLogFile(std::string &PerfLog) {
 }
 
 bool InitTimeStatistics(std::string LogFile) {
-  if (!PS) {
-    if (!env::needTimeStatistics()) {
-      return false;
-    }
+  if (Enabled.load(std::memory_order_acquire)) {
+    return true;
+  }
+  if (!env::needTimeStatistics()) {
+    return false;
+  }
 
+  std::lock_guard<std::mutex> Lock(InitMutex);
+  if (!PS) {
     if (LogFile == "") {
       GetLogFile(LogFile);
     }
 
-    PS = std::make_unique<PerfStats>();
-    if (!PS || !PS->Init(LogFile)) {
+    PerfStats *Stats = new (std::nothrow) PerfStats();
+    if (!Stats || !Stats->Init(LogFile)) {
       std::cerr << "TimeStatistics failed to initialize\n";
+      delete Stats;
       return false;
     }
+    PS = Stats;
     std::atexit(&dump);
+    Enabled.store(true, std::memory_order_release);
   }
   return true;
 }
 
-void ProfilePoint::finish() {
-  if (PS) {
-    double End = PS->getCurrentTime();
-    PS->AddToStats(Name, End - StartTime);
-  }
-
-  isFinished = true;
+uint64_t getTimeStamp() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
 }
 
-ProfilePoint::ProfilePoint(StringRef Tag) : Name(Tag) {
-  InitTimeStatistics("");
-  if (PS) {
-    StartTime = PS->getCurrentTime();
-  }
-}
+ThreadCounters::ThreadCounters() { PS->addThread(this); }
+ThreadCounters::~ThreadCounters() { PS->removeThread(this); }
 
-ProfilePoint::~ProfilePoint() {
-  if (!isFinished) {
-    finish();
+void getProfilePointTotals(
+    function_ref<void(StringRef, uint64_t, uint64_t)> Callback) {
+  if (Enabled.load(std::memory_order_acquire)) {
+    PS->getTotalsSinceReset(Callback);
   }
 }
 
-// Timer implementation
-#if defined _WIN64 || defined _WIN32
-class PerfTimerWindows : public PerfTimerImpl {
-
-public:
-  PerfTimerWindows(){};
-  virtual bool Init() override {
-    LARGE_INTEGER li;
-    if (QueryPerformanceCounter(&li))
-      CounterStart = li.QuadPart;
-    else {
-      std::cerr << "Failed to get performance counter\n";
-      return false;
-    }
-
-    if (!QueryPerformanceFrequency(&li)) {
-      std::cerr << "Failed to get performance frequency\n";
-      return false;
-    }
-    // QueryPerformanceFrequency returns counts per second
-    // If we need milliseconds we divide by 10^3
-    // TODO: granularity as env var
-    PCFreq = li.QuadPart / 1e3;
-    return true;
+void resetProfilePoints() {
+  if (Enabled.load(std::memory_order_acquire)) {
+    PS->reset();
   }
+}
 
-  virtual double getCurrentTime() override {
-    LARGE_INTEGER li;
-    if (QueryPerformanceCounter(&li))
-      return double(li.QuadPart) / PCFreq;
-    else {
-      std::cerr << "Failed to get performance counter\n";
-      return 0.0;
-    }
+#ifndef AMD_COMGR_DISABLE_PROFILE_POINTS
+ProfilePointId::ProfilePointId(StringRef Name) : Index(MaxProfilePoints) {
+  // Any profile point may be the first use of Comgr which needs statistics.
+  if (InitTimeStatistics("")) {
+    Index = PS->getIndex(Name);
   }
-};
-
-#elif defined __linux__
-class PerfTimerLinux : public PerfTimerImpl {
-public:
-  virtual bool Init() override {
-    struct timespec StartTime;
-    if (!clock_gettime(CLOCK_MONOTONIC_RAW, &StartTime)) {
-      CounterStart = StartTime.tv_sec * 1e9 + StartTime.tv_nsec;
-    } else {
-      std::cerr << "Failed to get performance counter\n";
-      return false;
-    }
+}
 
-    struct timespec Res;
-    if (clock_getres(CLOCK_MONOTONIC_RAW, &Res)) {
-      std::cerr << "Failed to get performance frequency\n";
-      return false;
-    }
-    // clock_getres returns counts per nanosecond
-    // If we need milliseconds we multiply by 10^6
-    // TODO: granularity as env var
-    PCFreq = (Res.tv_sec * 1e9 + Res.tv_nsec) * 1e6;
-    return true;
+ProfilePoint::ProfilePoint(StringRef Name) : Index(MaxProfilePoints) {
+  if (InitTimeStatistics("")) {
+    Index = PS->getIndex(Name);
+    StartTime = getTimeStamp();
   }
+}
 
-  virtual double getCurrentTime() override {
-    struct timespec EndTime;
-    if (!clock_gettime(CLOCK_MONOTONIC_RAW, &EndTime)) {
-      return (EndTime.tv_sec * 1e9 + EndTime.tv_nsec) / PCFreq;
-    }
-    std::cerr << "Failed to get performance counter\n";
-    return 0.0;
+void ProfilePoint::record(uint64_t Duration) {
+  // Counters are only created once a thread records its first point, which
+  // requires statistics to be enabled.
+  static thread_local ThreadCounters Counters;
+  if (Index < MaxProfilePoints) {
+    Counters.add(Index, Duration);
   }
-};
-#endif
-
-bool PerfTimer::Init() {
-#if defined _WIN64 || defined _WIN32
-  pImpl = std::make_unique<PerfTimerWindows>();
-#elif defined __linux__
-  pImpl = std::make_unique<PerfTimerLinux>();
-#endif
-  return pImpl->Init();
 }
+#endif
 
 } // namespace TimeStatistics
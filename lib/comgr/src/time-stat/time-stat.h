@@ -1,26 +1,76 @@
 #ifndef AMD_COMGR_TIME_STAT_H
 #define AMD_COMGR_TIME_STAT_H
 
-#include "perf-timer.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "amd_comgr.h"
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace TimeStatistics {
 
+// The maximum number of distinct profile point names. Points registered
+// beyond this are not recorded.
+constexpr unsigned MaxProfilePoints = 256;
+
 struct ProfileData {
-  double TimeTaken;
-  int Counter;
+  uint64_t TimeTaken = 0;
+  uint64_t Counter = 0;
+};
+
+// The counters of one thread. Only the owning thread writes them, the dump
+// reads them, so plain relaxed loads and stores suffice.
+struct ThreadCounters {
+  struct Entry {
+    std::atomic<uint64_t> TimeTaken{0};
+    std::atomic<uint64_t> Counter{0};
+  };
+
+  ThreadCounters();
+  ~ThreadCounters();
+
+  void add(unsigned Index, uint64_t Duration) {
+    Entry &E = Entries[Index];
+    E.TimeTaken.store(E.TimeTaken.load(std::memory_order_relaxed) + Duration,
+                      std::memory_order_relaxed);
+    E.Counter.store(E.Counter.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+  }
+
+  Entry Entries[MaxProfilePoints];
 };
 
 class PerfStats {
   std::unique_ptr<llvm::raw_fd_ostream,
                   std::function<void(llvm::raw_fd_ostream *)>>
       pLog;
-  PerfTimer PT;
 
-  llvm::StringMap<ProfileData> ProfileDataMap;
+  std::mutex Mutex;
+  llvm::StringMap<unsigned> Indices;
+  std::vector<std::string> Names;
+  // The counters of running threads, and the totals of exited threads.
+  std::set<ThreadCounters *> Threads;
+  ProfileData Retired[MaxProfilePoints];
+  // The totals at the last reset.
+  ProfileData Baseline[MaxProfilePoints];
+
+  ProfileData getTotal(unsigned I) {
+    ProfileData Total = Retired[I];
+    for (ThreadCounters *TC : Threads) {
+      Total.TimeTaken +=
+          TC->Entries[I].TimeTaken.load(std::memory_order_relaxed);
+      Total.Counter += TC->Entries[I].Counter.load(std::memory_order_relaxed);
+    }
+    return Total;
+  }
 
 public:
   PerfStats() {}
@@ -42,29 +92,74 @@ public:
       pLog = std::move(LogF);
     }
 
-    // Initialize Timer
-    if (!PT.Init())
-      return false;
-
     return true;
   }
 
-  double getCurrentTime() { return PT.getCurrentTime(); }
+  unsigned getIndex(llvm::StringRef Name) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Indices.try_emplace(Name, Names.size());
+    if (It.second) {
+      Names.push_back(Name.str());
+    }
+    return It.first->second;
+  }
+
+  void addThread(ThreadCounters *TC) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Threads.insert(TC);
+  }
+
+  void removeThread(ThreadCounters *TC) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (unsigned I = 0; I < MaxProfilePoints; ++I) {
+      Retired[I].TimeTaken +=
+          TC->Entries[I].TimeTaken.load(std::memory_order_relaxed);
+      Retired[I].Counter +=
+          TC->Entries[I].Counter.load(std::memory_order_relaxed);
+    }
+    Threads.erase(TC);
+  }
 
-  void AddToStats(llvm::StringRef Name, double TimeTaken) {
-    ProfileDataMap[Name].TimeTaken += TimeTaken;
-    ProfileDataMap[Name].Counter++;
+  void getTotalsSinceReset(
+      llvm::function_ref<void(llvm::StringRef, uint64_t, uint64_t)>
+          Callback) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (unsigned I = 0; I < Names.size() && I < MaxProfilePoints; ++I) {
+      ProfileData Total = getTotal(I);
+      if (Total.Counter != Baseline[I].Counter) {
+        Callback(Names[I], Total.Counter - Baseline[I].Counter,
+                 Total.TimeTaken - Baseline[I].TimeTaken);
+      }
+    }
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (unsigned I = 0; I < MaxProfilePoints; ++I) {
+      Baseline[I] = getTotal(I);
+    }
   }
 
+  // Write the statistics and close the log.
   void dumpPerfStats() {
-    for (const auto &Item : ProfileDataMap) {
-      *pLog << "Profile Point "
-            << llvm::format("%-50s", Item.getKey().str().c_str())
-            << " was invoked " << llvm::format("%6d", Item.getValue().Counter)
+    if (!pLog) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (unsigned I = 0; I < Names.size() && I < MaxProfilePoints; ++I) {
+      ProfileData Total = getTotal(I);
+      if (!Total.Counter) {
+        continue;
+      }
+      *pLog << "Profile Point " << llvm::format("%-50s", Names[I].c_str())
+            << " was invoked "
+            << llvm::format("%6llu", (unsigned long long)Total.Counter)
             << " times and took "
-            << llvm::format("%10.4f", Item.getValue().TimeTaken)
+            << llvm::format("%10.4f", Total.TimeTaken / 1e6)
             << " milliseconds overall\n";
     }
+    pLog.reset();
   }
 };
 
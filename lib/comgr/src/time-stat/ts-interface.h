@@ -1,23 +1,92 @@
 #ifndef AMD_COMGR_TS_INTERFACE_H
 #define AMD_COMGR_TS_INTERFACE_H
 
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
 // External interface
+//
+// Profile points are cheap enough to be left in hot code. Give each one a
+// ProfilePointId defined as a function-local static, so its name is only
+// registered once:
+//
+//   static ProfilePointId DecodeId("Decode");
+//   ProfilePoint Point(DecodeId);
+//
+// Unless time statistics were requested, a profile point only tests a flag.
+// Otherwise it adds its duration to a counter of the current thread; the
+// counters of all threads are summed when the statistics are dumped. Building
+// with AMD_COMGR_DISABLE_PROFILE_POINTS compiles profile points out entirely.
 
 namespace TimeStatistics {
 
+/// Whether time statistics are being collected.
+extern std::atomic<bool> Enabled;
+
+/// Return a monotonic time stamp in nanoseconds.
+uint64_t getTimeStamp();
+
+/// The registered name of a profile point. Identical names share an id.
+class ProfilePointId {
+public:
+#ifdef AMD_COMGR_DISABLE_PROFILE_POINTS
+  explicit ProfilePointId(llvm::StringRef Name) {}
+#else
+  explicit ProfilePointId(llvm::StringRef Name);
+#endif
+  unsigned getIndex() const { return Index; }
+
+private:
+  unsigned Index = 0;
+};
+
 struct ProfilePoint {
-  ProfilePoint(llvm::StringRef Name);
-  ~ProfilePoint();
-  void finish();
+#ifdef AMD_COMGR_DISABLE_PROFILE_POINTS
+  explicit ProfilePoint(const ProfilePointId &Id) {}
+  explicit ProfilePoint(llvm::StringRef Name) {}
+  void finish() {}
+#else
+  explicit ProfilePoint(const ProfilePointId &Id) : Index(Id.getIndex()) {
+    if (LLVM_UNLIKELY(Enabled.load(std::memory_order_relaxed))) {
+      StartTime = getTimeStamp();
+    }
+  }
+
+  /// Profile a point whose name is only known at run time. The name is looked
+  /// up on every call, so prefer a ProfilePointId in hot code.
+  explicit ProfilePoint(llvm::StringRef Name);
+
+  ~ProfilePoint() { finish(); }
+
+  void finish() {
+    if (LLVM_UNLIKELY(StartTime)) {
+      record(getTimeStamp() - StartTime);
+      StartTime = 0;
+    }
+  }
 
 private:
-  std::string Name = "";
-  double StartTime = 0.0;
-  bool isFinished = false;
+  void record(uint64_t Duration);
+
+  unsigned Index = 0;
+  // Zero unless the point is being timed.
+  uint64_t StartTime = 0;
+#endif
 };
 
 bool InitTimeStatistics(std::string LogFile);
+
+/// Call \p Callback with the name, invocation count and total nanoseconds of
+/// each profile point invoked since the last resetProfilePoints.
+void getProfilePointTotals(
+    llvm::function_ref<void(llvm::StringRef, uint64_t, uint64_t)> Callback);
+
+/// Restart the totals returned by getProfilePointTotals. The statistics
+/// dumped at exit are not affected.
+void resetProfilePoints();
 void StartAction(amd_comgr_action_kind_t);
 void EndAction();
 
@@ -0,0 +1,212 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compile KernelSource at Priority. Marker is passed as an option, so the
+// action can be told apart in the verbose log.
+static void compile(amd_comgr_action_priority_t Priority, const char *Marker) {
+  amd_comgr_data_set_t DataSetCl, DataSetBc;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  const char *Options[] = {Marker};
+
+  Status = amd_comgr_create_data_set(&DataSetCl);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetCl, AMD_COMGR_DATA_KIND_SOURCE, "source.cl", KernelSource,
+          strlen(KernelSource));
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx900");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+  Status = amd_comgr_action_info_set_priority(DataAction, Priority);
+  checkError(Status, "amd_comgr_action_info_set_priority");
+
+  Status = amd_comgr_create_data_set(&DataSetBc);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC,
+                               DataAction, DataSetCl, DataSetBc);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetCl);
+  checkError(Status, "amd_comgr_destroy_data_set");
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Read the log redirected to the FIFO at Path until Count actions have
+// written to it, and return the marker of each action in the order they were
+// admitted. An action writes its log while it is admitted, and opening the
+// FIFO for writing blocks until it is opened here.
+static std::vector<std::string> readAdmissionOrder(const char *Path,
+                                                   size_t Count) {
+  std::vector<std::string> Order;
+  std::string Log;
+  while (Order.size() < Count) {
+    int FD = open(Path, O_RDONLY);
+    if (FD == -1) {
+      fail("open : %s", Path);
+    }
+    char Buf[4096];
+    ssize_t Size;
+    while ((Size = read(FD, Buf, sizeof(Buf))) > 0) {
+      Log.append(Buf, Size);
+    }
+    close(FD);
+
+    // The marker of an action is logged several times, but never interleaved
+    // with those of other actions.
+    Order.clear();
+    for (size_t Pos = Log.find("ORDER_"); Pos != std::string::npos;
+         Pos = Log.find("ORDER_", Pos + 1)) {
+      size_t End = Log.find_first_not_of(
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_", Pos);
+      std::string Marker = Log.substr(Pos, End - Pos);
+      if (Order.empty() || Order.back() != Marker) {
+        Order.push_back(Marker);
+      }
+    }
+  }
+  return Order;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_action_priority_t Priority;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+
+  Status = amd_comgr_action_info_get_priority(DataAction, &Priority);
+  checkError(Status, "amd_comgr_action_info_get_priority");
+  if (Priority != AMD_COMGR_ACTION_PRIORITY_NORMAL) {
+    fail("default action priority is %d (expected normal)", Priority);
+  }
+
+  Status = amd_comgr_action_info_set_priority(
+      DataAction,
+      (amd_comgr_action_priority_t)(AMD_COMGR_ACTION_PRIORITY_LAST + 1));
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_action_info_set_priority accepted an invalid priority");
+  }
+
+  Status = amd_comgr_action_info_set_priority(DataAction,
+                                              AMD_COMGR_ACTION_PRIORITY_HIGH);
+  checkError(Status, "amd_comgr_action_info_set_priority");
+  Status = amd_comgr_action_info_get_priority(DataAction, &Priority);
+  checkError(Status, "amd_comgr_action_info_get_priority");
+  if (Priority != AMD_COMGR_ACTION_PRIORITY_HIGH) {
+    fail("action priority is %d (expected high)", Priority);
+  }
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  // The first action holds the only slot while it waits for the FIFO its log
+  // is redirected to to be opened. Low priority actions queue behind it, and
+  // then a high priority one, which must be admitted next.
+  char Path[] = "/tmp/comgr-action-priority-XXXXXX";
+  if (!mkdtemp(Path)) {
+    fail("mkdtemp");
+  }
+  std::string FifoPath = std::string(Path) + "/log";
+  if (mkfifo(FifoPath.c_str(), 0600)) {
+    fail("mkfifo : %s", FifoPath.c_str());
+  }
+  setenv("AMD_COMGR_REDIRECT_LOGS", FifoPath.c_str(), 1);
+  setenv("AMD_COMGR_EMIT_VERBOSE_LOGS", "1", 1);
+
+  const char *LowMarkers[] = {"-DORDER_LOW0", "-DORDER_LOW1", "-DORDER_LOW2",
+                              "-DORDER_LOW3"};
+  const size_t NumLow = sizeof(LowMarkers) / sizeof(LowMarkers[0]);
+  auto Settle = [] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  };
+
+  std::vector<std::thread> Threads;
+  Threads.emplace_back(compile, AMD_COMGR_ACTION_PRIORITY_NORMAL,
+                       "-DORDER_HOLD");
+  Settle();
+  for (const char *Marker : LowMarkers) {
+    Threads.emplace_back(compile, AMD_COMGR_ACTION_PRIORITY_LOW, Marker);
+  }
+  Settle();
+  Threads.emplace_back(compile, AMD_COMGR_ACTION_PRIORITY_HIGH,
+                       "-DORDER_HIGH");
+  Settle();
+
+  std::vector<std::string> Order =
+      readAdmissionOrder(FifoPath.c_str(), NumLow + 2);
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+  unlink(FifoPath.c_str());
+  rmdir(Path);
+
+  if (Order.size() != NumLow + 2 || Order[0] != "ORDER_HOLD" ||
+      Order[1] != "ORDER_HIGH") {
+    std::string Got;
+    for (auto &Marker : Order) {
+      Got += " " + Marker;
+    }
+    fail("actions were admitted in the order%s (expected ORDER_HOLD, then "
+         "ORDER_HIGH)",
+         Got.c_str());
+  }
+#endif
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *MixClasses[] = {
+    "valu", "salu",   "vmem_load", "vmem_store", "vmem_atomic", "smem",
+    "lds",  "export", "branch",    "waitcnt",    "other"};
+
+static unsigned long long lookupCount(amd_comgr_metadata_node_t Map,
+                                      const char *Key) {
+  amd_comgr_metadata_node_t Node;
+  amd_comgr_status_t Status;
+  char Buf[32];
+  size_t Size = sizeof(Buf);
+
+  Status = amd_comgr_metadata_lookup(Map, Key, &Node);
+  checkError(Status, "amd_comgr_metadata_lookup");
+  Status = amd_comgr_get_metadata_string(Node, &Size, Buf);
+  checkError(Status, "amd_comgr_get_metadata_string");
+  Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+
+  return strtoull(Buf, NULL, 10);
+}
+
+int main(int argc, char *argv[]) {
+  size_t Size;
+  char *Buf;
+  amd_comgr_data_t DataOut;
+  amd_comgr_data_set_t DataSetIn, DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_metadata_node_t Meta, Kernels, Kernel, Mix;
+  amd_comgr_status_t Status;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared.so", &Buf);
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_EXECUTABLE, "shared.so", Buf, Size);
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX,
+                               DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  size_t Count;
+  Status = amd_comgr_action_data_count(DataSetOut, AMD_COMGR_DATA_KIND_MSGPACK,
+                                       &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    fail("AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX produced %zu reports",
+         Count);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetOut, AMD_COMGR_DATA_KIND_MSGPACK, 0, &DataOut);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_get_data_metadata(DataOut, &Meta);
+  checkError(Status, "amd_comgr_get_data_metadata");
+
+  Status = amd_comgr_metadata_lookup(Meta, "amdcomgr.kernels", &Kernels);
+  checkError(Status, "amd_comgr_metadata_lookup");
+  Status = amd_comgr_get_metadata_list_size(Kernels, &Count);
+  checkError(Status, "amd_comgr_get_metadata_list_size");
+  if (Count != 1) {
+    fail("expected 1 kernel in report, found %zu", Count);
+  }
+
+  Status = amd_comgr_index_list_metadata(Kernels, 0, &Kernel);
+  checkError(Status, "amd_comgr_index_list_metadata");
+
+  unsigned long long InstCount = lookupCount(Kernel, ".instruction_count");
+  if (!InstCount || !lookupCount(Kernel, ".code_size")) {
+    fail("kernel reported as empty");
+  }
+
+  Status = amd_comgr_metadata_lookup(Kernel, ".instruction_mix", &Mix);
+  checkError(Status, "amd_comgr_metadata_lookup");
+
+  unsigned long long Total = 0;
+  for (size_t I = 0; I < sizeof(MixClasses) / sizeof(MixClasses[0]); ++I) {
+    Total += lookupCount(Mix, MixClasses[I]);
+  }
+  if (Total != InstCount) {
+    fail("instruction mix adds up to %llu, expected %llu", Total, InstCount);
+  }
+
+  // The kernel copies one int from one global pointer to another.
+  if (!lookupCount(Mix, "vmem_load") || !lookupCount(Mix, "vmem_store")) {
+    fail("kernel memory accesses not reported");
+  }
+
+  Status = amd_comgr_destroy_metadata(Mix);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(Kernel);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(Kernels);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(Meta);
+  checkError(Status, "amd_comgr_destroy_metadata");
+
+  Status = amd_comgr_release_data(DataOut);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  free(Buf);
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The blocks and edges of the function in source/cfg.s.
+static const size_t ExpectedBlockCount = 5;
+static const amd_comgr_cfg_edge_t ExpectedEdges[] = {
+    {0, 1}, {1, 1}, {1, 2}, {2, 4}, {2, 3}, {3, 4}};
+
+int main(int argc, char *argv[]) {
+  size_t Size;
+  char *Buf;
+  amd_comgr_data_t DataIn;
+  amd_comgr_cfg_info_t CFGInfo;
+  amd_comgr_cfg_function_t Function;
+  amd_comgr_status_t Status;
+
+  Size = setBuf(TEST_OBJ_DIR "/cfg.o", &Buf);
+
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_RELOCATABLE, &DataIn);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataIn, Size, Buf);
+  checkError(Status, "amd_comgr_set_data");
+
+  Status = amd_comgr_create_cfg_info(DataIn, &CFGInfo);
+  checkError(Status, "amd_comgr_create_cfg_info");
+
+  size_t Count;
+  Status = amd_comgr_get_cfg_function_count(CFGInfo, &Count);
+  checkError(Status, "amd_comgr_get_cfg_function_count");
+  if (Count != 1) {
+    fail("expected 1 function, found %zu", Count);
+  }
+
+  Status = amd_comgr_get_cfg_function(CFGInfo, 1, &Function);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_get_cfg_function accepted an out of range index");
+  }
+
+  Status = amd_comgr_get_cfg_function(CFGInfo, 0, &Function);
+  checkError(Status, "amd_comgr_get_cfg_function");
+
+  if (strcmp(Function.name, "loop")) {
+    fail("unexpected function name %s", Function.name);
+  }
+
+  if (Function.block_count != ExpectedBlockCount) {
+    fail("expected %zu blocks, found %zu", ExpectedBlockCount,
+         Function.block_count);
+  }
+
+  // Blocks tile the function in address order.
+  if (Function.blocks[0].start != Function.address ||
+      Function.blocks[Function.block_count - 1].end !=
+          Function.address + Function.size) {
+    fail("blocks do not cover the function");
+  }
+  for (size_t I = 1; I < Function.block_count; ++I) {
+    if (Function.blocks[I].start != Function.blocks[I - 1].end) {
+      fail("block %zu does not follow block %zu", I, I - 1);
+    }
+  }
+
+  size_t EdgeCount = sizeof(ExpectedEdges) / sizeof(ExpectedEdges[0]);
+  if (Function.edge_count != EdgeCount) {
+    fail("expected %zu edges, found %zu", EdgeCount, Function.edge_count);
+  }
+  for (size_t I = 0; I < EdgeCount; ++I) {
+    if (Function.edges[I].from != ExpectedEdges[I].from ||
+        Function.edges[I].to != ExpectedEdges[I].to) {
+      fail("edge %zu is %zu -> %zu, expected %zu -> %zu", I,
+           Function.edges[I].from, Function.edges[I].to,
+           ExpectedEdges[I].from, ExpectedEdges[I].to);
+    }
+  }
+
+  if (Function.call_count != 0) {
+    fail("expected no calls, found %zu", Function.call_count);
+  }
+
+  Status = amd_comgr_destroy_cfg_info(CFGInfo);
+  checkError(Status, "amd_comgr_destroy_cfg_info");
+  Status = amd_comgr_release_data(DataIn);
+  checkError(Status, "amd_comgr_release_data");
+  free(Buf);
+
+  return 0;
+}
@@ -103,6 +103,50 @@ void checkError(amd_comgr_status_t status, const char *str) {
   }
 }
 
+// A minimal OpenCL kernel, for tests that only need something to compile.
+const char *KernelSource = "kernel void f(global int *p) { *p = 1; }";
+
+// Add a data object of dataKind named name, holding the size bytes at buf, to
+// dataSet.
+void addData(amd_comgr_data_set_t dataSet, amd_comgr_data_kind_t dataKind,
+             const char *name, const char *buf, size_t size) {
+  amd_comgr_data_t data;
+  amd_comgr_status_t status;
+
+  status = amd_comgr_create_data(dataKind, &data);
+  checkError(status, "amd_comgr_create_data");
+  status = amd_comgr_set_data(data, size, buf);
+  checkError(status, "amd_comgr_set_data");
+  status = amd_comgr_set_data_name(data, name);
+  checkError(status, "amd_comgr_set_data_name");
+  status = amd_comgr_data_set_add(dataSet, data);
+  checkError(status, "amd_comgr_data_set_add");
+  status = amd_comgr_release_data(data);
+  checkError(status, "amd_comgr_release_data");
+}
+
+// Add a data object of dataKind named name, holding the contents of the file
+// at path, to dataSet.
+void addFile(amd_comgr_data_set_t dataSet, amd_comgr_data_kind_t dataKind,
+             const char *path, const char *name) {
+  char *buf;
+  size_t size = setBuf(path, &buf);
+
+  addData(dataSet, dataKind, name, buf, size);
+  free(buf);
+}
+
+// Create *dataSetOut and perform the action kind from dataSetIn into it,
+// failing the test if the action does not succeed.
+void doAction(amd_comgr_action_kind_t kind, amd_comgr_action_info_t actionInfo,
+              amd_comgr_data_set_t dataSetIn,
+              amd_comgr_data_set_t *dataSetOut) {
+  amd_comgr_status_t status = amd_comgr_create_data_set(dataSetOut);
+  checkError(status, "amd_comgr_create_data_set");
+  status = amd_comgr_do_action(kind, actionInfo, dataSetIn, *dataSetOut);
+  checkError(status, "amd_comgr_do_action");
+}
+
 void dumpData(amd_comgr_data_t Data, const char *OutFile) {
   size_t size;
   char *bytes = NULL;
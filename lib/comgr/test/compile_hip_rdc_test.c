@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *getData(amd_comgr_data_set_t DataSet, size_t Index,
+                     size_t *Size) {
+  amd_comgr_data_t Data;
+  amd_comgr_status_t Status;
+  char *Buf;
+
+  Status = amd_comgr_action_data_get_data(DataSet, AMD_COMGR_DATA_KIND_BC,
+                                          Index, &Data);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_get_data(Data, Size, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Buf = (char *)malloc(*Size);
+  Status = amd_comgr_get_data(Data, Size, Buf);
+  checkError(Status, "amd_comgr_get_data");
+  Status = amd_comgr_release_data(Data);
+  checkError(Status, "amd_comgr_release_data");
+
+  return Buf;
+}
+
+int main(int argc, char *argv[]) {
+  amd_comgr_data_set_t DataSetIn, DataSetBc, DataSetBcAgain, DataSetLinked,
+      DataSetReloc, DataSetExec;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_data_t DataExec;
+  amd_comgr_symbol_t Symbol;
+  amd_comgr_status_t Status;
+  const char *Options[] = {"-fgpu-rdc"};
+  size_t Count, I;
+
+  // rdc1.hip uses a __device__ variable and function defined in rdc2.hip.
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/rdc1.hip",
+          "rdc1.hip");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/rdc2.hip",
+          "rdc2.hip");
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status =
+      amd_comgr_action_info_set_language(DataAction, AMD_COMGR_LANGUAGE_HIP);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx906");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC, DataAction,
+           DataSetIn, &DataSetBc);
+
+  Status = amd_comgr_action_data_count(DataSetBc, AMD_COMGR_DATA_KIND_BC,
+                                       &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 2) {
+    printf("Failed, %zu bitcode objects (expected 2)\n", Count);
+    exit(1);
+  }
+
+  // Recompiling a translation unit must give the same bitcode, so that it can
+  // be cached per translation unit.
+  doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_WITH_DEVICE_LIBS_TO_BC, DataAction,
+           DataSetIn, &DataSetBcAgain);
+
+  for (I = 0; I < Count; ++I) {
+    size_t Size, SizeAgain;
+    char *Bc = getData(DataSetBc, I, &Size);
+    char *BcAgain = getData(DataSetBcAgain, I, &SizeAgain);
+    if (Size != SizeAgain || memcmp(Bc, BcAgain, Size)) {
+      printf("Failed, bitcode %zu differs between compilations\n", I);
+      exit(1);
+    }
+    free(Bc);
+    free(BcAgain);
+  }
+
+  // The device link resolves the references between translation units.
+  Status = amd_comgr_action_info_set_option_list(DataAction, NULL, 0);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  doAction(AMD_COMGR_ACTION_LINK_BC_TO_BC, DataAction, DataSetBc,
+           &DataSetLinked);
+  doAction(AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction,
+           DataSetLinked, &DataSetReloc);
+  doAction(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, DataAction,
+           DataSetReloc, &DataSetExec);
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetExec, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_symbol_lookup(DataExec, "_Z4rdc1Pi", &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+  Status = amd_comgr_symbol_lookup(DataExec, "Counter", &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBcAgain);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetLinked);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetReloc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExec);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Disassemble DataSetIn with Option, and check which of the functions "first",
+// "second" and "third" appear in the output.
+static void testFilter(amd_comgr_data_set_t DataSetIn, const char *Option,
+                       int ExpectFirst, int ExpectSecond, int ExpectThird) {
+  amd_comgr_data_t DataOut;
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  size_t Count;
+  char *Bytes;
+  const char *Options[] = {Option};
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  Status =
+      amd_comgr_do_action(AMD_COMGR_ACTION_DISASSEMBLE_RELOCATABLE_TO_SOURCE,
+                          DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetOut, AMD_COMGR_DATA_KIND_SOURCE, 0, &DataOut);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_get_data(DataOut, &Count, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Bytes = (char *)calloc(Count + 1, sizeof(char));
+  Status = amd_comgr_get_data(DataOut, &Count, Bytes);
+  checkError(Status, "amd_comgr_get_data");
+
+  if (!!strstr(Bytes, "\nfirst:\n") != ExpectFirst ||
+      !!strstr(Bytes, "\nsecond:\n") != ExpectSecond ||
+      !!strstr(Bytes, "\nthird:\n") != ExpectThird) {
+    printf("FAILED: unexpected functions disassembled with %s:\n%s\n", Option,
+           Bytes);
+    exit(1);
+  }
+
+  free(Bytes);
+  Status = amd_comgr_release_data(DataOut);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+}
+
+// Disassembling DataSetIn with the malformed Option must fail rather than
+// terminate the process.
+static void testInvalidRange(amd_comgr_data_set_t DataSetIn,
+                             const char *Option) {
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  const char *Options[] = {Option};
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  Status =
+      amd_comgr_do_action(AMD_COMGR_ACTION_DISASSEMBLE_RELOCATABLE_TO_SOURCE,
+                          DataAction, DataSetIn, DataSetOut);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("FAILED: %s was not rejected as an invalid argument\n", Option);
+    exit(1);
+  }
+
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+}
+
+int main(int argc, char *argv[]) {
+  size_t Size;
+  char *Buf;
+  amd_comgr_data_set_t DataSetIn;
+  amd_comgr_status_t Status;
+
+  // first, second and third are at 0x0, 0x100 and 0x200.
+  Size = setBuf(TEST_OBJ_DIR "/disasm-filter.o", &Buf);
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_RELOCATABLE, "DO_IN", Buf, Size);
+
+  testFilter(DataSetIn, "-file-headers", 1, 1, 1);
+  testFilter(DataSetIn, "-df=second", 0, 1, 0);
+  testFilter(DataSetIn, "-df=first,third", 1, 0, 1);
+  testFilter(DataSetIn, "-disassemble-range=0x204-0x208", 0, 0, 1);
+  testFilter(DataSetIn, "-disassemble-range=0x0-0x4,0x1fc-0x200", 1, 1, 0);
+  testInvalidRange(DataSetIn, "-disassemble-range=0x10-0x4");
+  testInvalidRange(DataSetIn, "-disassemble-range=abc");
+
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  free(Buf);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MARKER "/*in-memory*/ "
+
+// Disassemble DataSetIn with source interleaving, and check that the source
+// lines come from the in-memory copy marked with MARKER.
+static void testSource(amd_comgr_data_set_t DataSetIn) {
+  amd_comgr_data_t DataOut;
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  size_t Count;
+  char *Bytes;
+  const char *Options[] = {"-S"};
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  Status =
+      amd_comgr_do_action(AMD_COMGR_ACTION_DISASSEMBLE_RELOCATABLE_TO_SOURCE,
+                          DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_action_data_count(DataSetOut, AMD_COMGR_DATA_KIND_SOURCE,
+                                       &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    fail("AMD_COMGR_ACTION_DISASSEMBLE_RELOCATABLE_TO_SOURCE Failed: "
+         "produced %zu source objects (expected 1)\n",
+         Count);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetOut, AMD_COMGR_DATA_KIND_SOURCE, 0, &DataOut);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_get_data(DataOut, &Count, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Bytes = (char *)calloc(Count + 1, sizeof(char));
+  Status = amd_comgr_get_data(DataOut, &Count, Bytes);
+  checkError(Status, "amd_comgr_get_data");
+
+  if (!strstr(Bytes, "; " MARKER)) {
+    printf("FAILED: disassembly not annotated from the data set:\n%s\n",
+           Bytes);
+    exit(1);
+  }
+
+  free(Bytes);
+  Status = amd_comgr_release_data(DataOut);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+}
+
+int main(int argc, char *argv[]) {
+  size_t Size, SourceSize, MarkedSize, I;
+  char *Buf, *BufSource, *BufMarked;
+  amd_comgr_data_set_t DataSetIn;
+  amd_comgr_status_t Status;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared-debug.o", &Buf);
+  SourceSize = setBuf(TEST_OBJ_DIR "/shared.cl", &BufSource);
+
+  // Prefix every line of the source with MARKER, so that lines read from disk
+  // can be told apart from lines read from the data set.
+  BufMarked = (char *)malloc(SourceSize * (strlen(MARKER) + 1) + 1);
+  MarkedSize = 0;
+  for (I = 0; I < SourceSize; ++I) {
+    if (I == 0 || BufSource[I - 1] == '\n') {
+      memcpy(BufMarked + MarkedSize, MARKER, strlen(MARKER));
+      MarkedSize += strlen(MARKER);
+    }
+    BufMarked[MarkedSize++] = BufSource[I];
+  }
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_RELOCATABLE, "DO_IN", Buf, Size);
+
+  // The debug info names the file by its path at compile time; the data
+  // object name only has to match its trailing components.
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, "shared.cl", BufMarked,
+          MarkedSize);
+
+  // The second action reuses the cached line index of the source.
+  testSource(DataSetIn);
+  testSource(DataSetIn);
+
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  free(Buf);
+  free(BufSource);
+  free(BufMarked);
+
+  return 0;
+}
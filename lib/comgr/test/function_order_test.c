@@ -0,0 +1,190 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t getAddress(amd_comgr_data_t DataExec, const char *Name) {
+  amd_comgr_symbol_t Symbol;
+  amd_comgr_status_t Status;
+  uint64_t Address;
+
+  Status = amd_comgr_symbol_lookup(DataExec, Name, &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+  Status = amd_comgr_symbol_get_info(Symbol, AMD_COMGR_SYMBOL_INFO_VALUE,
+                                     &Address);
+  checkError(Status, "amd_comgr_symbol_get_info");
+
+  return Address;
+}
+
+int main(int argc, char *argv[]) {
+  char *Asm;
+  amd_comgr_data_set_t DataSetIn, DataSetBc, DataSetLinked, DataSetAsm,
+      DataSetReloc, DataSetExec;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_data_t DataAsm, DataExec;
+  amd_comgr_status_t Status;
+  const char *Order[] = {"source2", "source1"};
+  size_t Count, Size;
+  char Name[sizeof("source2")];
+  char *Source1, *Source2;
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source1.cl",
+          "source1.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source2.cl",
+          "source2.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_INCLUDE, TEST_OBJ_DIR "/include-a.h",
+          "include-a.h");
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  Status = amd_comgr_action_info_set_function_order_list(DataAction, NULL, 1);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("Failed, NULL function order with non-zero count accepted\n");
+    exit(1);
+  }
+
+  doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction, DataSetIn,
+           &DataSetBc);
+  doAction(AMD_COMGR_ACTION_LINK_BC_TO_BC, DataAction, DataSetBc,
+           &DataSetLinked);
+
+  // The linked bitcode defines source1 before source2, so the order reverses
+  // the default layout.
+  Status = amd_comgr_action_info_set_function_order_list(DataAction, Order, 2);
+  checkError(Status, "amd_comgr_action_info_set_function_order_list");
+  Status =
+      amd_comgr_action_info_get_function_order_list_count(DataAction, &Count);
+  checkError(Status, "amd_comgr_action_info_get_function_order_list_count");
+  if (Count != 2) {
+    printf("Failed, %zu functions in order (expected 2)\n", Count);
+    exit(1);
+  }
+  Status = amd_comgr_action_info_get_function_order_list_item(DataAction, 0,
+                                                              &Size, NULL);
+  checkError(Status, "amd_comgr_action_info_get_function_order_list_item");
+  if (Size != sizeof(Name)) {
+    printf("Failed, function name size %zu (expected %zu)\n", Size,
+           sizeof(Name));
+    exit(1);
+  }
+  Status = amd_comgr_action_info_get_function_order_list_item(DataAction, 0,
+                                                              &Size, Name);
+  checkError(Status, "amd_comgr_action_info_get_function_order_list_item");
+  if (strcmp(Name, Order[0])) {
+    printf("Failed, function name %s (expected %s)\n", Name, Order[0]);
+    exit(1);
+  }
+
+  doAction(AMD_COMGR_ACTION_CODEGEN_BC_TO_ASSEMBLY, DataAction, DataSetLinked,
+           &DataSetAsm);
+
+  Status = amd_comgr_action_data_get_data(DataSetAsm,
+                                          AMD_COMGR_DATA_KIND_SOURCE, 0,
+                                          &DataAsm);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_get_data(DataAsm, &Size, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Asm = calloc(Size + 1, sizeof(char));
+  Status = amd_comgr_get_data(DataAsm, &Size, Asm);
+  checkError(Status, "amd_comgr_get_data");
+
+  Source1 = strstr(Asm, "\nsource1:");
+  Source2 = strstr(Asm, "\nsource2:");
+  if (!Source1 || !Source2 || Source2 > Source1) {
+    printf("Failed, source2 is not emitted before source1\n");
+    exit(1);
+  }
+
+  doAction(AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction,
+           DataSetLinked, &DataSetReloc);
+  doAction(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, DataAction,
+           DataSetReloc, &DataSetExec);
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetExec, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  if (getAddress(DataExec, "source2") > getAddress(DataExec, "source1")) {
+    printf("Failed, source2 is not laid out before source1\n");
+    exit(1);
+  }
+
+  Status = amd_comgr_action_info_set_function_order_list(DataAction, NULL, 0);
+  checkError(Status, "amd_comgr_action_info_set_function_order_list");
+  Status =
+      amd_comgr_action_info_get_function_order_list_count(DataAction, &Count);
+  checkError(Status, "amd_comgr_action_info_get_function_order_list_count");
+  if (Count != 0) {
+    printf("Failed, %zu functions in cleared order (expected 0)\n", Count);
+    exit(1);
+  }
+
+  Status = amd_comgr_release_data(DataAsm);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetLinked);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetAsm);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetReloc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExec);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  free(Asm);
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Introspect many copies of a code object with an increasing number of
+// threads, and check that every thread count computes the same facts.
+
+static const size_t NumObjects = 256;
+
+static double introspect(amd_comgr_data_set_t DataSet, size_t ThreadCount,
+                         size_t &SymbolCount) {
+  amd_comgr_introspection_info_t Info;
+  amd_comgr_introspection_result_t Result;
+  amd_comgr_status_t Status;
+  size_t Count;
+
+  auto Start = std::chrono::steady_clock::now();
+  Status = amd_comgr_create_introspection_info(
+      DataSet, AMD_COMGR_INTROSPECTION_FACT_ALL, ThreadCount, &Info);
+  checkError(Status, "amd_comgr_create_introspection_info");
+  auto End = std::chrono::steady_clock::now();
+
+  Status = amd_comgr_get_introspection_result_count(Info, &Count);
+  checkError(Status, "amd_comgr_get_introspection_result_count");
+  if (Count != NumObjects) {
+    fail("%zu introspection results (expected %zu)", Count, NumObjects);
+  }
+
+  SymbolCount = 0;
+  for (size_t I = 0; I < Count; ++I) {
+    Status = amd_comgr_get_introspection_result(Info, I, &Result);
+    checkError(Status, "amd_comgr_get_introspection_result");
+    checkError(Result.status, "introspection result");
+    if (Result.kernel_count != 1) {
+      fail("object %zu has %zu kernels (expected 1)", I, Result.kernel_count);
+    }
+    SymbolCount += Result.symbol_count;
+  }
+
+  Status = amd_comgr_destroy_introspection_info(Info);
+  checkError(Status, "amd_comgr_destroy_introspection_info");
+
+  return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+
+int main(int argc, char *argv[]) {
+  char *Buf;
+  size_t Size;
+  amd_comgr_data_set_t DataSet;
+  amd_comgr_status_t Status;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared.so", &Buf);
+
+  Status = amd_comgr_create_data_set(&DataSet);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  std::vector<amd_comgr_data_t> Objects(NumObjects);
+  for (size_t I = 0; I < NumObjects; ++I) {
+    Status =
+        amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &Objects[I]);
+    checkError(Status, "amd_comgr_create_data");
+    Status = amd_comgr_set_data(Objects[I], Size, Buf);
+    checkError(Status, "amd_comgr_set_data");
+    Status = amd_comgr_data_set_add(DataSet, Objects[I]);
+    checkError(Status, "amd_comgr_data_set_add");
+  }
+
+  size_t MaxThreads = std::thread::hardware_concurrency();
+  if (!MaxThreads) {
+    MaxThreads = 1;
+  }
+
+  size_t SerialSymbols;
+  double Serial = introspect(DataSet, 1, SerialSymbols);
+  printf("%zu objects, 1 thread: %.2f ms\n", NumObjects, Serial);
+
+  for (size_t Threads = 2; Threads <= MaxThreads; Threads *= 2) {
+    size_t Symbols;
+    double Time = introspect(DataSet, Threads, Symbols);
+    if (Symbols != SerialSymbols) {
+      fail("%zu threads found %zu symbols (expected %zu)", Threads, Symbols,
+           SerialSymbols);
+    }
+    printf("%zu objects, %zu threads: %.2f ms (%.2fx)\n", NumObjects, Threads,
+           Time, Serial / Time);
+  }
+
+  for (amd_comgr_data_t Data : Objects) {
+    Status = amd_comgr_release_data(Data);
+    checkError(Status, "amd_comgr_release_data");
+  }
+  Status = amd_comgr_destroy_data_set(DataSet);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  free(Buf);
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static amd_comgr_status_t countSymbol(amd_comgr_symbol_t Symbol,
+                                      void *UserData) {
+  (*(size_t *)UserData)++;
+  return AMD_COMGR_STATUS_SUCCESS;
+}
+
+// Check the facts of one code object against the single object queries.
+static void checkResult(const amd_comgr_introspection_result_t *Result,
+                        amd_comgr_data_t Data, const char *Kernel) {
+  char IsaName[256];
+  size_t Size = sizeof(IsaName), SymbolCount = 0;
+  amd_comgr_metadata_kind_t Kind;
+  amd_comgr_status_t Status;
+
+  if (Result->data.handle != Data.handle) {
+    fail("result is not in data set order");
+  }
+  checkError(Result->status, "introspection result");
+
+  Status = amd_comgr_get_data_isa_name(Data, &Size, IsaName);
+  checkError(Status, "amd_comgr_get_data_isa_name");
+  if (!Result->isa_name || strcmp(Result->isa_name, IsaName)) {
+    fail("isa name %s (expected %s)", Result->isa_name, IsaName);
+  }
+
+  Status = amd_comgr_get_metadata_kind(Result->metadata, &Kind);
+  checkError(Status, "amd_comgr_get_metadata_kind");
+  if (Kind != AMD_COMGR_METADATA_KIND_MAP) {
+    fail("metadata root is not a map");
+  }
+
+  Status = amd_comgr_iterate_symbols(Data, countSymbol, &SymbolCount);
+  checkError(Status, "amd_comgr_iterate_symbols");
+  if (Result->symbol_count != SymbolCount) {
+    fail("%zu symbols (expected %zu)", Result->symbol_count, SymbolCount);
+  }
+
+  if (Result->kernel_count != 1 ||
+      strcmp(Result->kernel_names[0], Kernel)) {
+    fail("unexpected kernels of %s", Kernel);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  size_t Size1, Size2, Count;
+  char *Buf1, *Buf2;
+  amd_comgr_data_t DataExec, DataReloc, DataBc;
+  amd_comgr_data_set_t DataSet;
+  amd_comgr_introspection_info_t Info;
+  amd_comgr_introspection_result_t Result;
+  amd_comgr_status_t Status;
+
+  Size1 = setBuf(TEST_OBJ_DIR "/shared.so", &Buf1);
+  Size2 = setBuf(TEST_OBJ_DIR "/reloc1.o", &Buf2);
+
+  Status = amd_comgr_create_data_set(&DataSet);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSet, AMD_COMGR_DATA_KIND_EXECUTABLE, "shared.so", Buf1, Size1);
+  addData(DataSet, AMD_COMGR_DATA_KIND_RELOCATABLE, "reloc1.o", Buf2, Size2);
+  addData(DataSet, AMD_COMGR_DATA_KIND_BC, "reloc1.bc", Buf2, Size2);
+  Status = amd_comgr_action_data_get_data(
+      DataSet, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_action_data_get_data(
+      DataSet, AMD_COMGR_DATA_KIND_RELOCATABLE, 0, &DataReloc);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_action_data_get_data(DataSet, AMD_COMGR_DATA_KIND_BC, 0,
+                                          &DataBc);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_create_introspection_info(DataSet, 0, 0, &Info);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_create_introspection_info accepted no facts");
+  }
+  Status = amd_comgr_create_introspection_info(DataSet, 0x10, 0, &Info);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_create_introspection_info accepted an unknown fact");
+  }
+
+  Status = amd_comgr_create_introspection_info(
+      DataSet, AMD_COMGR_INTROSPECTION_FACT_ALL, 0, &Info);
+  checkError(Status, "amd_comgr_create_introspection_info");
+
+  Status = amd_comgr_get_introspection_result_count(Info, &Count);
+  checkError(Status, "amd_comgr_get_introspection_result_count");
+  if (Count != 3) {
+    fail("%zu introspection results (expected 3)", Count);
+  }
+
+  Status = amd_comgr_get_introspection_result(Info, 0, &Result);
+  checkError(Status, "amd_comgr_get_introspection_result");
+  checkResult(&Result, DataExec,
+              "bazzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz");
+
+  Status = amd_comgr_get_introspection_result(Info, 1, &Result);
+  checkError(Status, "amd_comgr_get_introspection_result");
+  checkResult(&Result, DataReloc, "foo");
+
+  // A failure is reported for the object alone, and leaves its facts empty.
+  Status = amd_comgr_get_introspection_result(Info, 2, &Result);
+  checkError(Status, "amd_comgr_get_introspection_result");
+  if (Result.data.handle != DataBc.handle ||
+      Result.status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("introspection of a bitcode object did not fail");
+  }
+  if (Result.isa_name || Result.metadata.handle || Result.symbol_count ||
+      Result.kernel_count) {
+    fail("unexpected facts for a failed introspection");
+  }
+
+  Status = amd_comgr_get_introspection_result(Info, 3, &Result);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_get_introspection_result accepted an invalid index");
+  }
+
+  Status = amd_comgr_destroy_introspection_info(Info);
+  checkError(Status, "amd_comgr_destroy_introspection_info");
+
+  // Only the requested facts are computed.
+  Status = amd_comgr_create_introspection_info(
+      DataSet, AMD_COMGR_INTROSPECTION_FACT_KERNELS, 1, &Info);
+  checkError(Status, "amd_comgr_create_introspection_info");
+  Status = amd_comgr_get_introspection_result(Info, 0, &Result);
+  checkError(Status, "amd_comgr_get_introspection_result");
+  if (Result.isa_name || Result.metadata.handle || Result.symbol_count ||
+      Result.kernel_count != 1) {
+    fail("unexpected facts with only kernels requested");
+  }
+  Status = amd_comgr_destroy_introspection_info(Info);
+  checkError(Status, "amd_comgr_destroy_introspection_info");
+
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataReloc);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataBc);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSet);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  free(Buf1);
+  free(Buf2);
+
+  return 0;
+}
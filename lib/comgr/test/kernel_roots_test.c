@@ -0,0 +1,173 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Check whether the executable in DataSetExec defines Name.
+static void expectSymbol(amd_comgr_data_set_t DataSetExec, const char *Name,
+                         int Expected) {
+  amd_comgr_data_t DataExec;
+  amd_comgr_symbol_t Symbol;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetExec, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_symbol_lookup(DataExec, Name, &Symbol);
+  if (Expected) {
+    checkError(Status, "amd_comgr_symbol_lookup");
+  } else if (Status != AMD_COMGR_STATUS_ERROR) {
+    printf("Failed, unused kernel %s was not eliminated\n", Name);
+    exit(1);
+  }
+
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+}
+
+int main(int argc, char *argv[]) {
+  amd_comgr_data_set_t DataSetIn, DataSetBc, DataSetLinked, DataSetReloc,
+      DataSetExec, DataSetRelocTU, DataSetExecTU, DataSetExecLTO;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  const char *Roots[] = {"source2"};
+  const char *CallerRoots[] = {"source1"};
+  size_t Count, Size;
+  char Name[sizeof("source2")];
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source1.cl",
+          "source1.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source2.cl",
+          "source2.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_INCLUDE, TEST_OBJ_DIR "/include-a.h",
+          "include-a.h");
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  Status = amd_comgr_action_info_set_kernel_root_list(DataAction, NULL, 1);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("Failed, NULL kernel root list with non-zero count accepted\n");
+    exit(1);
+  }
+
+  doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction, DataSetIn,
+           &DataSetBc);
+
+  // source1 calls source2, so keeping only source2 removes source1.
+  Status = amd_comgr_action_info_set_kernel_root_list(DataAction, Roots, 1);
+  checkError(Status, "amd_comgr_action_info_set_kernel_root_list");
+  Status = amd_comgr_action_info_get_kernel_root_list_count(DataAction, &Count);
+  checkError(Status, "amd_comgr_action_info_get_kernel_root_list_count");
+  if (Count != 1) {
+    printf("Failed, %zu kernel roots (expected 1)\n", Count);
+    exit(1);
+  }
+  Status = amd_comgr_action_info_get_kernel_root_list_item(DataAction, 0,
+                                                           &Size, NULL);
+  checkError(Status, "amd_comgr_action_info_get_kernel_root_list_item");
+  if (Size != sizeof(Name)) {
+    printf("Failed, kernel root size %zu (expected %zu)\n", Size,
+           sizeof(Name));
+    exit(1);
+  }
+  Status = amd_comgr_action_info_get_kernel_root_list_item(DataAction, 0,
+                                                           &Size, Name);
+  checkError(Status, "amd_comgr_action_info_get_kernel_root_list_item");
+  if (strcmp(Name, Roots[0])) {
+    printf("Failed, kernel root %s (expected %s)\n", Name, Roots[0]);
+    exit(1);
+  }
+
+  doAction(AMD_COMGR_ACTION_LINK_BC_TO_BC, DataAction, DataSetBc,
+           &DataSetLinked);
+  doAction(AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction,
+           DataSetLinked, &DataSetReloc);
+  doAction(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, DataAction,
+           DataSetReloc, &DataSetExec);
+
+  expectSymbol(DataSetExec, "source2", 1);
+  expectSymbol(DataSetExec, "source1", 0);
+
+  // source2 is defined in another translation unit than its caller source1,
+  // so it must survive code generation of each unit on its own. The ThinLTO
+  // link of both may internalize it, but must still resolve the call.
+  Status =
+      amd_comgr_action_info_set_kernel_root_list(DataAction, CallerRoots, 1);
+  checkError(Status, "amd_comgr_action_info_set_kernel_root_list");
+  doAction(AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction, DataSetBc,
+           &DataSetRelocTU);
+  doAction(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, DataAction,
+           DataSetRelocTU, &DataSetExecTU);
+  expectSymbol(DataSetExecTU, "source1", 1);
+  expectSymbol(DataSetExecTU, "source2", 1);
+
+  doAction(AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE, DataAction, DataSetBc,
+           &DataSetExecLTO);
+  expectSymbol(DataSetExecLTO, "source1", 1);
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetLinked);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetReloc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExec);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetRelocTU);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExecTU);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExecLTO);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  return 0;
+}
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KERNEL_NAME "bazzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz"
+
+static int hasDebugInfo(amd_comgr_data_t Data) {
+  const char *Name = ".debug_info";
+  size_t NameLen = strlen(Name);
+  size_t Size;
+  char *Bytes;
+  int Found = 0;
+
+  amd_comgr_status_t Status = amd_comgr_get_data(Data, &Size, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Bytes = (char *)malloc(Size);
+  Status = amd_comgr_get_data(Data, &Size, Bytes);
+  checkError(Status, "amd_comgr_get_data");
+
+  for (size_t I = 0; !Found && I + NameLen <= Size; ++I) {
+    Found = !memcmp(Bytes + I, Name, NameLen);
+  }
+
+  free(Bytes);
+  return Found;
+}
+
+static size_t getDataSize(amd_comgr_data_t Data) {
+  size_t Size;
+  amd_comgr_status_t Status = amd_comgr_get_data(Data, &Size, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  return Size;
+}
+
+static amd_comgr_data_set_t linkWithMode(amd_comgr_data_set_t DataSetIn,
+                                         amd_comgr_debug_info_mode_t Mode,
+                                         amd_comgr_data_t *DataExec) {
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_debug_info_mode_t GotMode;
+  amd_comgr_status_t Status;
+  size_t Count;
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_debug_info_mode(DataAction, Mode);
+  checkError(Status, "amd_comgr_action_info_set_debug_info_mode");
+  Status = amd_comgr_action_info_get_debug_info_mode(DataAction, &GotMode);
+  checkError(Status, "amd_comgr_action_info_get_debug_info_mode");
+  if (GotMode != Mode) {
+    printf("Failed, debug info mode %d (should be %d)\n", GotMode, Mode);
+    exit(1);
+  }
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE,
+                               DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_action_data_count(DataSetOut,
+                                       AMD_COMGR_DATA_KIND_EXECUTABLE, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    printf("Failed, output %zd executable objects (should output 1)\n", Count);
+    exit(1);
+  }
+
+  Status = amd_comgr_action_data_count(DataSetOut,
+                                       AMD_COMGR_DATA_KIND_DEBUG_INFO, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != (Mode == AMD_COMGR_DEBUG_INFO_MODE_SPLIT)) {
+    printf("Failed, output %zd debug info objects for mode %d\n", Count, Mode);
+    exit(1);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetOut, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  return DataSetOut;
+}
+
+static void collectSymbolizedString(const char *Input, void *Data) {
+  char **Result = (char **)Data;
+  size_t Size = strlen(Input);
+  *Result = (char *)malloc(Size + 1);
+  memcpy(*Result, Input, Size + 1);
+}
+
+int main(int argc, char *argv[]) {
+  size_t Size;
+  char *Buf;
+  amd_comgr_data_t DataKeep, DataStrip, DataCompress, DataSplit,
+      DataDebug;
+  amd_comgr_data_set_t DataSetIn, DataSetKeep, DataSetStrip, DataSetCompress,
+      DataSetSplit;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_symbol_t Symbol;
+  amd_comgr_symbolizer_info_t Symbolizer;
+  amd_comgr_status_t Status;
+  uint64_t Address;
+  char *Symbolized = NULL;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared-debug.o", &Buf);
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_RELOCATABLE, "shared-debug.o", Buf,
+          Size);
+
+  // Invalid modes are rejected.
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_debug_info_mode(
+      DataAction,
+      (amd_comgr_debug_info_mode_t)(AMD_COMGR_DEBUG_INFO_MODE_LAST + 1));
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("Failed, invalid debug info mode accepted\n");
+    exit(1);
+  }
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  DataSetKeep =
+      linkWithMode(DataSetIn, AMD_COMGR_DEBUG_INFO_MODE_KEEP, &DataKeep);
+  DataSetStrip =
+      linkWithMode(DataSetIn, AMD_COMGR_DEBUG_INFO_MODE_STRIP, &DataStrip);
+  DataSetCompress = linkWithMode(DataSetIn, AMD_COMGR_DEBUG_INFO_MODE_COMPRESS,
+                                 &DataCompress);
+  DataSetSplit =
+      linkWithMode(DataSetIn, AMD_COMGR_DEBUG_INFO_MODE_SPLIT, &DataSplit);
+
+  if (!hasDebugInfo(DataKeep)) {
+    printf("Failed, debug info missing with AMD_COMGR_DEBUG_INFO_MODE_KEEP\n");
+    exit(1);
+  }
+
+  if (hasDebugInfo(DataStrip) ||
+      getDataSize(DataStrip) >= getDataSize(DataKeep)) {
+    printf("Failed, debug info not stripped\n");
+    exit(1);
+  }
+
+  if (!hasDebugInfo(DataCompress) ||
+      getDataSize(DataCompress) >= getDataSize(DataKeep)) {
+    printf("Failed, debug info not compressed\n");
+    exit(1);
+  }
+
+  if (hasDebugInfo(DataSplit)) {
+    printf("Failed, debug info not split from the executable\n");
+    exit(1);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetSplit, AMD_COMGR_DATA_KIND_DEBUG_INFO, 0, &DataDebug);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  if (!hasDebugInfo(DataDebug)) {
+    printf("Failed, debug info object does not contain debug info\n");
+    exit(1);
+  }
+
+  // Addresses of the stripped executable are symbolized with the split debug
+  // info object.
+  Status = amd_comgr_symbol_lookup(DataSplit, KERNEL_NAME, &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+  Status = amd_comgr_symbol_get_info(Symbol, AMD_COMGR_SYMBOL_INFO_VALUE,
+                                     &Address);
+  checkError(Status, "amd_comgr_symbol_get_info");
+
+  Status = amd_comgr_create_symbolizer_info(DataDebug, &collectSymbolizedString,
+                                            &Symbolizer);
+  checkError(Status, "amd_comgr_create_symbolizer_info");
+  Status = amd_comgr_symbolize(Symbolizer, Address, true, &Symbolized);
+  checkError(Status, "amd_comgr_symbolize");
+  if (!Symbolized || strncmp(Symbolized, KERNEL_NAME, strlen(KERNEL_NAME))) {
+    printf("Failed, symbolized %s (should start with %s)\n",
+           Symbolized ? Symbolized : "nothing", KERNEL_NAME);
+    exit(1);
+  }
+  free(Symbolized);
+  Status = amd_comgr_destroy_symbolizer_info(Symbolizer);
+  checkError(Status, "amd_comgr_destroy_symbolizer_info");
+
+  Status = amd_comgr_release_data(DataKeep);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataStrip);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataCompress);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataSplit);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataDebug);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetKeep);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetStrip);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetCompress);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetSplit);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  free(Buf);
+
+  return 0;
+}
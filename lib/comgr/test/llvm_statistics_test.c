@@ -0,0 +1,173 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t countStatistics(amd_comgr_data_set_t DataSet) {
+  amd_comgr_status_t Status;
+  size_t Count, I, Found = 0;
+
+  Status = amd_comgr_action_data_count(DataSet, AMD_COMGR_DATA_KIND_MSGPACK,
+                                       &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+
+  for (I = 0; I < Count; ++I) {
+    amd_comgr_data_t Data;
+    amd_comgr_metadata_node_t Meta;
+    amd_comgr_metadata_kind_t Kind;
+    char Name[32];
+    size_t NameSize;
+
+    Status = amd_comgr_action_data_get_data(
+        DataSet, AMD_COMGR_DATA_KIND_MSGPACK, I, &Data);
+    checkError(Status, "amd_comgr_action_data_get_data");
+    Status = amd_comgr_get_data_name(Data, &NameSize, NULL);
+    checkError(Status, "amd_comgr_get_data_name");
+    if (NameSize <= sizeof(Name)) {
+      Status = amd_comgr_get_data_name(Data, &NameSize, Name);
+      checkError(Status, "amd_comgr_get_data_name");
+    }
+    if (NameSize > sizeof(Name) || strcmp(Name, "llvm-statistics")) {
+      Status = amd_comgr_release_data(Data);
+      checkError(Status, "amd_comgr_release_data");
+      continue;
+    }
+
+    // Whether any statistic is counted depends on how LLVM was built, so
+    // only the shape of the result is checked.
+    Status = amd_comgr_get_data_metadata(Data, &Meta);
+    checkError(Status, "amd_comgr_get_data_metadata");
+    Status = amd_comgr_get_metadata_kind(Meta, &Kind);
+    checkError(Status, "amd_comgr_get_metadata_kind");
+    if (Kind != AMD_COMGR_METADATA_KIND_MAP) {
+      fail("LLVM statistics are not a map");
+    }
+
+    Status = amd_comgr_destroy_metadata(Meta);
+    checkError(Status, "amd_comgr_destroy_metadata");
+    Status = amd_comgr_release_data(Data);
+    checkError(Status, "amd_comgr_release_data");
+    ++Found;
+  }
+
+  return Found;
+}
+
+static size_t compile(amd_comgr_action_info_t DataAction,
+                      amd_comgr_data_set_t DataSetIn) {
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_status_t Status;
+  size_t Count;
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status =
+      amd_comgr_do_action(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC,
+                          DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  Count = countStatistics(DataSetOut);
+
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  return Count;
+}
+
+int main(int argc, char *argv[]) {
+  amd_comgr_data_set_t DataSetCl;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  bool LLVMStatistics;
+
+  Status = amd_comgr_create_data_set(&DataSetCl);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetCl, AMD_COMGR_DATA_KIND_SOURCE, "source.cl", KernelSource,
+          strlen(KernelSource));
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx900");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  Status = amd_comgr_action_info_get_llvm_statistics(DataAction,
+                                                     &LLVMStatistics);
+  checkError(Status, "amd_comgr_action_info_get_llvm_statistics");
+  if (LLVMStatistics) {
+    fail("LLVM statistics collected by default");
+  }
+  Status = amd_comgr_action_info_get_llvm_statistics(DataAction, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_action_info_get_llvm_statistics accepted NULL");
+  }
+
+  if (compile(DataAction, DataSetCl)) {
+    fail("LLVM statistics returned without being requested");
+  }
+
+  Status = amd_comgr_action_info_set_llvm_statistics(DataAction, true);
+  checkError(Status, "amd_comgr_action_info_set_llvm_statistics");
+  Status = amd_comgr_action_info_get_llvm_statistics(DataAction,
+                                                     &LLVMStatistics);
+  checkError(Status, "amd_comgr_action_info_get_llvm_statistics");
+  if (!LLVMStatistics) {
+    fail("LLVM statistics not enabled");
+  }
+
+  if (compile(DataAction, DataSetCl) != 1) {
+    fail("expected one LLVM statistics data object");
+  }
+
+  // Once enabled, statistics stay enabled in LLVM, but are only returned by
+  // actions requesting them.
+  Status = amd_comgr_action_info_set_llvm_statistics(DataAction, false);
+  checkError(Status, "amd_comgr_action_info_set_llvm_statistics");
+  if (compile(DataAction, DataSetCl)) {
+    fail("LLVM statistics returned after being disabled");
+  }
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetCl);
+  checkError(Status, "amd_comgr_destroy_data_set");
+}
@@ -0,0 +1,122 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOAD_BASE 0x7f0000000000ULL
+
+int main(int argc, char *argv[]) {
+  size_t Size, ImageSize;
+  char *Buf, *Image;
+  amd_comgr_data_t DataExec, DataReloc, DataImage;
+  amd_comgr_status_t Status;
+  amd_comgr_load_image_header_t Header;
+  amd_comgr_load_image_kernel_t Kernel;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared.so", &Buf);
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &DataExec);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataExec, Size, Buf);
+  checkError(Status, "amd_comgr_set_data");
+
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_RELOCATABLE, &DataReloc);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataReloc, Size, Buf);
+  checkError(Status, "amd_comgr_set_data");
+
+  Status = amd_comgr_create_load_image(DataReloc, LOAD_BASE, &DataImage);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_create_load_image accepted a relocatable");
+  }
+  Status = amd_comgr_create_load_image(DataExec, LOAD_BASE, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_create_load_image accepted a NULL image");
+  }
+
+  Status = amd_comgr_create_load_image(DataExec, LOAD_BASE, &DataImage);
+  checkError(Status, "amd_comgr_create_load_image");
+
+  Status = amd_comgr_get_data(DataImage, &ImageSize, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Image = (char *)malloc(ImageSize);
+  Status = amd_comgr_get_data(DataImage, &ImageSize, Image);
+  checkError(Status, "amd_comgr_get_data");
+
+  if (ImageSize < sizeof(Header)) {
+    fail("load image of %zu bytes is smaller than its header", ImageSize);
+  }
+  memcpy(&Header, Image, sizeof(Header));
+  if (Header.magic != AMD_COMGR_LOAD_IMAGE_MAGIC ||
+      Header.version != AMD_COMGR_LOAD_IMAGE_VERSION ||
+      Header.load_base != LOAD_BASE) {
+    fail("invalid load image header");
+  }
+  if (Header.segment_offset % Header.segment_align ||
+      Header.segment_offset + Header.segment_size != ImageSize) {
+    fail("segments at 0x%" PRIx64 " of 0x%" PRIx64 " bytes do not end the "
+         "load image of 0x%zx bytes",
+         Header.segment_offset, Header.segment_size, ImageSize);
+  }
+
+  // shared.so has a single kernel.
+  if (Header.kernel_count != 1) {
+    fail("load image has %" PRIu64 " kernels (expected 1)",
+         Header.kernel_count);
+  }
+  memcpy(&Kernel, Image + Header.kernel_offset, sizeof(Kernel));
+  if (strcmp(Image + Kernel.name_offset,
+             "bazzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz")) {
+    fail("unexpected kernel name %s", Image + Kernel.name_offset);
+  }
+  if (Kernel.descriptor_offset + 64 > Header.segment_size ||
+      Kernel.entry_offset >= Header.segment_size) {
+    fail("kernel descriptor or entry outside of the segments");
+  }
+
+  free(Image);
+  Status = amd_comgr_release_data(DataImage);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataReloc);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+  free(Buf);
+
+  return 0;
+}
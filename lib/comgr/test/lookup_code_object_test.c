@@ -140,6 +140,22 @@ void fatbinTest(const char *FatBin, amd_comgr_data_kind_t Kind) {
     fail("Lookup failed for existent code object");
   }
 
+  amd_comgr_code_object_info_t FileQueryList[3] = {
+      {IsaStrings[0], 0, 0}, {IsaStrings[1], 0, 0}, {IsaStrings[2], 0, 0}};
+
+  Status = amd_comgr_lookup_code_object_from_file(FD, 0, size, FileQueryList,
+                                                  3);
+  checkError(Status, "amd_comgr_lookup_code_object_from_file");
+  for (int I = 0; I < 3; I++) {
+    if (FileQueryList[I].offset != QueryList3[I].offset ||
+        FileQueryList[I].size != QueryList3[I].size) {
+      fail("Lookup from file does not match lookup from data object");
+    }
+  }
+
+  Status = amd_comgr_release_data(DataObject);
+  checkError(Status, "amd_comgr_release_data");
+
 #if defined(_WIN32) || defined(_WIN64)
   _close(FD);
 #else
@@ -181,6 +197,97 @@ void sharedObjectTest(amd_comgr_data_kind_t Kind) {
   free(Buf);
 }
 
+void sharedObjectFileTest() {
+  const char *SharedObject = TEST_OBJ_DIR "/shared.so";
+
+#if defined(_WIN32) || defined(_WIN64)
+  struct _stat st;
+  _stat(SharedObject, &st);
+  int FD = _open(SharedObject, _O_RDONLY);
+#else
+  struct stat st;
+  stat(SharedObject, &st);
+  int FD = open(SharedObject, O_RDONLY);
+#endif
+
+  if (FD < 0) {
+    fail("open failed for %s with errno %d", SharedObject, errno);
+  }
+
+  amd_comgr_code_object_info_t QueryList[2] = {
+      {"amdgcn-amd-amdhsa--gfx700", 0, 0}, {"amdgcn-amd-amdhsa--gfx803", 0, 0}};
+
+  amd_comgr_status_t Status =
+      amd_comgr_lookup_code_object_from_file(FD, 0, st.st_size, QueryList, 2);
+  checkError(Status, "amd_comgr_lookup_code_object_from_file");
+
+  if (QueryList[0].offset != 0 || QueryList[0].size != 0) {
+    fail("Lookup succeeded for non-existent code object");
+  }
+
+  if (QueryList[1].offset != 0 || QueryList[1].size != (size_t)st.st_size) {
+    fail("Lookup failed for code object");
+  }
+
+  Status = amd_comgr_lookup_code_object_from_file(FD, 0, 0, QueryList, 2);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_lookup_code_object_from_file accepted an empty slice");
+  }
+
+#if defined(_WIN32) || defined(_WIN64)
+  _close(FD);
+#else
+  close(FD);
+#endif
+}
+
+// Look up a bundle whose entry table claims more than the slice holds. The
+// slice is larger than the initial read window, so the lookup must reject the
+// bundle as malformed rather than keep reading more of it.
+void malformedBundleFileTest(uint64_t NumOfCodeObjects,
+                             uint64_t BundleEntryIDSize) {
+  const char *Path = TEST_OBJ_DIR "/malformed.fatbin";
+  const char Magic[] = "__CLANG_OFFLOAD_BUNDLE__";
+  static char Bundle[64 * 1024];
+  uint64_t Entry[4] = {NumOfCodeObjects, 0, 0, BundleEntryIDSize};
+
+  memset(Bundle, 0, sizeof(Bundle));
+  memcpy(Bundle, Magic, sizeof(Magic) - 1);
+  memcpy(Bundle + sizeof(Magic) - 1, Entry, sizeof(Entry));
+
+  FILE *File = fopen(Path, "wb");
+  if (!File || fwrite(Bundle, 1, sizeof(Bundle), File) != sizeof(Bundle)) {
+    fail("failed to write %s", Path);
+  }
+  fclose(File);
+
+#if defined(_WIN32) || defined(_WIN64)
+  int FD = _open(Path, _O_RDONLY | _O_BINARY);
+#else
+  int FD = open(Path, O_RDONLY);
+#endif
+  if (FD < 0) {
+    fail("open failed for %s with errno %d", Path, errno);
+  }
+
+  amd_comgr_code_object_info_t QueryList[1] = {
+      {"amdgcn-amd-amdhsa--gfx803", 0, 0}};
+  amd_comgr_status_t Status = amd_comgr_lookup_code_object_from_file(
+      FD, 0, sizeof(Bundle), QueryList, 1);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_lookup_code_object_from_file accepted a malformed bundle "
+         "with %" PRIu64 " entries and an ID of %" PRIu64 " bytes",
+         NumOfCodeObjects, BundleEntryIDSize);
+  }
+
+#if defined(_WIN32) || defined(_WIN64)
+  _close(FD);
+#else
+  close(FD);
+#endif
+  remove(Path);
+}
+
 int main() {
 #ifdef HIP_COMPILER
   createFatBinary("source1.hip", TEST_OBJ_DIR "/source1.hip",
@@ -203,4 +310,7 @@ int main() {
 
   sharedObjectTest(AMD_COMGR_DATA_KIND_EXECUTABLE);
   sharedObjectTest(AMD_COMGR_DATA_KIND_BYTES);
+  sharedObjectFileTest();
+  malformedBundleFileTest(UINT64_C(1) << 40, 0);
+  malformedBundleFileTest(1, UINT64_C(1) << 40);
 }
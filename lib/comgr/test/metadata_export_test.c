@@ -0,0 +1,167 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+  char *Buf, *Json;
+  long Size1;
+  size_t Size, SmallSize;
+  amd_comgr_data_t DataIn, DataPacked, DataMapKey, DataBytes;
+  amd_comgr_metadata_node_t Meta, MetaPacked, MetaVersion, MetaMajor,
+      MetaMapKey, MetaBytes;
+  amd_comgr_metadata_kind_t Mkind;
+  amd_comgr_status_t Status;
+  uint64_t Major;
+
+  Size1 = setBuf(TEST_OBJ_DIR "/shared-v3.so", &Buf);
+
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &DataIn);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataIn, Size1, Buf);
+  checkError(Status, "amd_comgr_set_data");
+
+  Status = amd_comgr_get_data_metadata(DataIn, &Meta);
+  checkError(Status, "amd_comgr_get_data_metadata");
+
+  Status = amd_comgr_export_metadata(
+      Meta, (amd_comgr_metadata_format_t)(AMD_COMGR_METADATA_FORMAT_LAST + 1),
+      &Size, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_export_metadata accepted an invalid format");
+  }
+
+  // Export to JSON in a caller provided buffer
+  Status = amd_comgr_export_metadata(Meta, AMD_COMGR_METADATA_FORMAT_JSON,
+                                     &Size, NULL);
+  checkError(Status, "amd_comgr_export_metadata");
+  Json = (char *)calloc(Size + 1, 1);
+  if (!Json) {
+    fail("calloc failed");
+  }
+
+  SmallSize = Size - 1;
+  Status = amd_comgr_export_metadata(Meta, AMD_COMGR_METADATA_FORMAT_JSON,
+                                     &SmallSize, Json);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT || SmallSize != Size) {
+    fail("amd_comgr_export_metadata accepted a small buffer");
+  }
+
+  Status = amd_comgr_export_metadata(Meta, AMD_COMGR_METADATA_FORMAT_JSON,
+                                     &Size, Json);
+  checkError(Status, "amd_comgr_export_metadata");
+  if (Json[0] != '{' || !strstr(Json, "\"amdhsa.version\":[1,") ||
+      !strstr(Json, "\".kernarg_segment_size\":16")) {
+    fail("unexpected JSON metadata: %s", Json);
+  }
+  free(Json);
+
+  // Export to MsgPack, and read it back
+  Status = amd_comgr_export_metadata_to_data(
+      Meta, AMD_COMGR_METADATA_FORMAT_MSGPACK, &DataPacked);
+  checkError(Status, "amd_comgr_export_metadata_to_data");
+
+  Status = amd_comgr_get_data_metadata(DataPacked, &MetaPacked);
+  checkError(Status, "amd_comgr_get_data_metadata");
+  Status = amd_comgr_get_metadata_kind(MetaPacked, &Mkind);
+  checkError(Status, "amd_comgr_get_metadata_kind");
+  if (Mkind != AMD_COMGR_METADATA_KIND_MAP) {
+    fail("exported MsgPack root is not a map");
+  }
+
+  Status = amd_comgr_metadata_lookup(MetaPacked, "amdhsa.version",
+                                     &MetaVersion);
+  checkError(Status, "amd_comgr_metadata_lookup");
+  Status = amd_comgr_index_list_metadata(MetaVersion, 0, &MetaMajor);
+  checkError(Status, "amd_comgr_index_list_metadata");
+  Status = amd_comgr_get_metadata_uint64(MetaMajor, &Major);
+  checkError(Status, "amd_comgr_get_metadata_uint64");
+  if (Major != 1) {
+    fail("exported amdhsa.version major is %" PRIu64 " (expected 1)", Major);
+  }
+
+  // A MsgPack map whose key is the map {"a": 1} has no JSON form
+  const char MapKey[] = {'\x81', '\x81', '\xa1', 'a', '\x01', '\x01'};
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_MSGPACK, &DataMapKey);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataMapKey, sizeof(MapKey), MapKey);
+  checkError(Status, "amd_comgr_set_data");
+  Status = amd_comgr_get_data_metadata(DataMapKey, &MetaMapKey);
+  checkError(Status, "amd_comgr_get_data_metadata");
+
+  Status = amd_comgr_export_metadata(MetaMapKey, AMD_COMGR_METADATA_FORMAT_JSON,
+                                     &Size, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_export_metadata accepted a map key which is a map");
+  }
+
+  Status = amd_comgr_destroy_metadata(MetaMapKey);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_release_data(DataMapKey);
+  checkError(Status, "amd_comgr_release_data");
+
+  // Bytes are not metadata, even if they happen to decode as MsgPack
+  const char Bytes[] = {'\x81', '\xa1', 'a', '\x01'};
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_BYTES, &DataBytes);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataBytes, sizeof(Bytes), Bytes);
+  checkError(Status, "amd_comgr_set_data");
+  Status = amd_comgr_get_data_metadata(DataBytes, &MetaBytes);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_get_data_metadata accepted a bytes data object");
+  }
+  Status = amd_comgr_release_data(DataBytes);
+  checkError(Status, "amd_comgr_release_data");
+
+  Status = amd_comgr_destroy_metadata(MetaMajor);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(MetaVersion);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(MetaPacked);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(Meta);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_release_data(DataPacked);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_release_data(DataIn);
+  checkError(Status, "amd_comgr_release_data");
+  free(Buf);
+
+  return 0;
+}
@@ -90,6 +90,69 @@ int main(int argc, char *argv[]) {
       printf("Lookup of Version should return a list\n");
       exit(1);
     }
+
+    // Read scalars with the typed getters
+    amd_comgr_metadata_node_t MetaMajor, MetaKernels, MetaKernel, MetaName;
+    uint64_t Major;
+    bool Bool;
+    const char *NameView;
+    size_t NameViewSize, NameSize;
+    char *Name;
+
+    Status = amd_comgr_index_list_metadata(MetaLookup, 0, &MetaMajor);
+    checkError(Status, "amd_comgr_index_list_metadata");
+    Status = amd_comgr_get_metadata_uint64(MetaMajor, &Major);
+    checkError(Status, "amd_comgr_get_metadata_uint64");
+    if (Major != 1) {
+      fail("amdhsa.version major is %" PRIu64 " (expected 1)", Major);
+    }
+    Status = amd_comgr_get_metadata_bool(MetaMajor, &Bool);
+    if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+      fail("amd_comgr_get_metadata_bool accepted an integer");
+    }
+    Status = amd_comgr_get_metadata_string_view(MetaMajor, &NameView,
+                                                &NameViewSize);
+    if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+      fail("amd_comgr_get_metadata_string_view accepted an integer");
+    }
+    Status = amd_comgr_destroy_metadata(MetaMajor);
+    checkError(Status, "amd_comgr_destroy_metadata");
+
+    Status = amd_comgr_metadata_lookup(Meta, "amdhsa.kernels", &MetaKernels);
+    checkError(Status, "amd_comgr_metadata_lookup");
+    Status = amd_comgr_index_list_metadata(MetaKernels, 0, &MetaKernel);
+    checkError(Status, "amd_comgr_index_list_metadata");
+    Status = amd_comgr_metadata_lookup(MetaKernel, ".name", &MetaName);
+    checkError(Status, "amd_comgr_metadata_lookup");
+
+    Status = amd_comgr_get_metadata_string_view(MetaName, &NameView,
+                                                &NameViewSize);
+    checkError(Status, "amd_comgr_get_metadata_string_view");
+    Status = amd_comgr_get_metadata_string(MetaName, &NameSize, NULL);
+    checkError(Status, "amd_comgr_get_metadata_string");
+    Name = (char *)malloc(NameSize);
+    if (!Name) {
+      fail("malloc failed");
+    }
+    Status = amd_comgr_get_metadata_string(MetaName, &NameSize, Name);
+    checkError(Status, "amd_comgr_get_metadata_string");
+    if (NameViewSize + 1 != NameSize ||
+        strncmp(NameView, Name, NameViewSize)) {
+      fail("amd_comgr_get_metadata_string_view returned %.*s (expected %s)",
+           (int)NameViewSize, NameView, Name);
+    }
+    free(Name);
+    Status = amd_comgr_get_metadata_uint64(MetaName, &Major);
+    if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+      fail("amd_comgr_get_metadata_uint64 accepted a string");
+    }
+
+    Status = amd_comgr_destroy_metadata(MetaName);
+    checkError(Status, "amd_comgr_destroy_metadata");
+    Status = amd_comgr_destroy_metadata(MetaKernel);
+    checkError(Status, "amd_comgr_destroy_metadata");
+    Status = amd_comgr_destroy_metadata(MetaKernels);
+    checkError(Status, "amd_comgr_destroy_metadata");
     Status = amd_comgr_destroy_metadata(MetaLookup);
     checkError(Status, "amd_comgr_destroy_metadata");
 
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_OBJECTS 3
+
+int main(int argc, char *argv[]) {
+  const char *FileNames[NUM_OBJECTS] = {TEST_OBJ_DIR "/shared12-v3.so",
+                                        TEST_OBJ_DIR "/shared14-v3.so",
+                                        TEST_OBJ_DIR "/shared-v3.so"};
+  const char *InvalidPaths[] = {"",
+                                "amdhsa.kernels[",
+                                "amdhsa.kernels[0",
+                                "amdhsa.kernels[.name==]",
+                                "amdhsa.kernels[.name==\"test1_v3]",
+                                "amdhsa.kernels[.name=test1_v3]"};
+  amd_comgr_data_t Data[NUM_OBJECTS];
+  amd_comgr_metadata_node_t Values[NUM_OBJECTS], Root, Value;
+  amd_comgr_status_t Statuses[NUM_OBJECTS];
+  amd_comgr_metadata_query_t Query;
+  amd_comgr_status_t Status;
+  uint64_t Size;
+  size_t I;
+
+  for (I = 0; I < NUM_OBJECTS; ++I) {
+    char *Buf;
+    long BufSize = setBuf(FileNames[I], &Buf);
+
+    Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &Data[I]);
+    checkError(Status, "amd_comgr_create_data");
+    Status = amd_comgr_set_data(Data[I], BufSize, Buf);
+    checkError(Status, "amd_comgr_set_data");
+    free(Buf);
+  }
+
+  for (I = 0; I < sizeof(InvalidPaths) / sizeof(InvalidPaths[0]); ++I) {
+    Status = amd_comgr_create_metadata_query(InvalidPaths[I], &Query);
+    if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+      fail("amd_comgr_create_metadata_query accepted \"%s\"", InvalidPaths[I]);
+    }
+  }
+
+  // Evaluate a query against a metadata root
+  Status = amd_comgr_create_metadata_query(
+      "amdhsa.kernels[.name==\"test2_v3\"].kernarg_segment_size", &Query);
+  checkError(Status, "amd_comgr_create_metadata_query");
+
+  Status = amd_comgr_get_data_metadata(Data[0], &Root);
+  checkError(Status, "amd_comgr_get_data_metadata");
+  Status = amd_comgr_evaluate_metadata_query(Query, Root, &Value);
+  checkError(Status, "amd_comgr_evaluate_metadata_query");
+  Status = amd_comgr_get_metadata_uint64(Value, &Size);
+  checkError(Status, "amd_comgr_get_metadata_uint64");
+  if (Size != 56) {
+    fail("test2_v3 kernarg segment size is %" PRIu64 " (expected 56)", Size);
+  }
+  Status = amd_comgr_destroy_metadata(Value);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_destroy_metadata(Root);
+  checkError(Status, "amd_comgr_destroy_metadata");
+
+  Status = amd_comgr_get_data_metadata(Data[1], &Root);
+  checkError(Status, "amd_comgr_get_data_metadata");
+  Status = amd_comgr_evaluate_metadata_query(Query, Root, &Value);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_evaluate_metadata_query found test2_v3 in %s",
+         FileNames[1]);
+  }
+  Status = amd_comgr_destroy_metadata(Root);
+  checkError(Status, "amd_comgr_destroy_metadata");
+
+  Status = amd_comgr_destroy_metadata_query(Query);
+  checkError(Status, "amd_comgr_destroy_metadata_query");
+
+  // Evaluate a query against the metadata of many code objects
+  Status = amd_comgr_create_metadata_query(
+      "amdhsa.kernels[.name==\"test1_v3\"].kernarg_segment_size", &Query);
+  checkError(Status, "amd_comgr_create_metadata_query");
+
+  Status = amd_comgr_evaluate_metadata_query_batch(Query, NUM_OBJECTS, Data,
+                                                   Values, Statuses);
+  checkError(Status, "amd_comgr_evaluate_metadata_query_batch");
+
+  for (I = 0; I < 2; ++I) {
+    checkError(Statuses[I], "amd_comgr_evaluate_metadata_query_batch");
+    Status = amd_comgr_get_metadata_uint64(Values[I], &Size);
+    checkError(Status, "amd_comgr_get_metadata_uint64");
+    if (Size != 56) {
+      fail("test1_v3 kernarg segment size in %s is %" PRIu64 " (expected 56)",
+           FileNames[I], Size);
+    }
+    Status = amd_comgr_destroy_metadata(Values[I]);
+    checkError(Status, "amd_comgr_destroy_metadata");
+  }
+  if (Statuses[2] != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_evaluate_metadata_query_batch found test1_v3 in %s",
+         FileNames[2]);
+  }
+
+  Status = amd_comgr_destroy_metadata_query(Query);
+  checkError(Status, "amd_comgr_destroy_metadata_query");
+
+  for (I = 0; I < NUM_OBJECTS; ++I) {
+    Status = amd_comgr_release_data(Data[I]);
+    checkError(Status, "amd_comgr_release_data");
+  }
+
+  return 0;
+}
@@ -329,9 +329,131 @@ void testFlatSplitting() {
   free(BufInclude);
 }
 
+amd_comgr_action_info_t createFrozen(const char *Options) {
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  bool Frozen;
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_options(DataAction, Options);
+  checkError(Status, "amd_comgr_action_info_set_options");
+
+  Status = amd_comgr_action_info_is_frozen(DataAction, &Frozen);
+  checkError(Status, "amd_comgr_action_info_is_frozen");
+  if (Frozen) {
+    fail("new action_info is frozen");
+  }
+
+  Status = amd_comgr_action_info_freeze(DataAction);
+  checkError(Status, "amd_comgr_action_info_freeze");
+  // Freezing again has no effect.
+  Status = amd_comgr_action_info_freeze(DataAction);
+  checkError(Status, "amd_comgr_action_info_freeze");
+
+  Status = amd_comgr_action_info_is_frozen(DataAction, &Frozen);
+  checkError(Status, "amd_comgr_action_info_is_frozen");
+  if (!Frozen) {
+    fail("amd_comgr_action_info_freeze did not freeze action_info");
+  }
+
+  return DataAction;
+}
+
+void testFrozen() {
+  amd_comgr_data_set_t DataSetIn, DataSetBc, DataSetDevLibs;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  size_t Size;
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source1.cl",
+          "source1.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_INCLUDE, TEST_OBJ_DIR "/include-a.h",
+          "include-a.h");
+
+  // A frozen action_info can no longer be modified, but can still be queried
+  // and used for any number of actions.
+  DataAction = createFrozen("-mllvm -amdgpu-early-inline-all");
+
+  Status = amd_comgr_action_info_set_options(DataAction, "-O3");
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_action_info_set_options does not fail when frozen");
+  }
+  Status = amd_comgr_action_info_set_option_list(DataAction, NULL, 0);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_action_info_set_option_list does not fail when frozen");
+  }
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_2_0);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("amd_comgr_action_info_set_language does not fail when frozen");
+  }
+
+  Status = amd_comgr_action_info_get_options(DataAction, &Size, NULL);
+  checkError(Status, "amd_comgr_action_info_get_options");
+  if (Size != sizeof("-mllvm -amdgpu-early-inline-all")) {
+    fail("incorrect frozen options size: expected %zu, saw %zu",
+         sizeof("-mllvm -amdgpu-early-inline-all"), Size);
+  }
+
+  for (int I = 0; I < 2; ++I) {
+    doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction, DataSetIn,
+             &DataSetBc);
+    if (I == 0) {
+      Status = amd_comgr_destroy_data_set(DataSetBc);
+      checkError(Status, "amd_comgr_destroy_data_set");
+    }
+  }
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  // Device library options are still split on ',' once frozen.
+  DataAction = createFrozen("finite_only,unsafe_math");
+
+  for (int I = 0; I < 2; ++I) {
+    doAction(AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES, DataAction, DataSetBc,
+             &DataSetDevLibs);
+    Status = amd_comgr_destroy_data_set(DataSetDevLibs);
+    checkError(Status, "amd_comgr_destroy_data_set");
+  }
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  // Invalid device library options are only reported by the action.
+  DataAction = createFrozen("finite_only,finite_only");
+
+  Status = amd_comgr_create_data_set(&DataSetDevLibs);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES,
+                               DataAction, DataSetBc, DataSetDevLibs);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("repeated device library option accepted when frozen");
+  }
+
+  Status = amd_comgr_destroy_data_set(DataSetDevLibs);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+}
+
 int main(int argc, char *argv[]) {
   testFlats();
   testLists();
   testMixed();
   testFlatSplitting();
+  testFrozen();
 }
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+
+#define NUM_OBJECTS 3
+#define PADDING 64
+
+int main(int argc, char *argv[]) {
+  const char *FileName = "comgr_pack_test_file.bin";
+  const char *Names[NUM_OBJECTS] = {"source.cl", "include.h", "blob"};
+  amd_comgr_data_kind_t Kinds[NUM_OBJECTS] = {AMD_COMGR_DATA_KIND_SOURCE,
+                                              AMD_COMGR_DATA_KIND_INCLUDE,
+                                              AMD_COMGR_DATA_KIND_BYTES};
+  char Blob[200];
+  const char *Contents[NUM_OBJECTS] = {
+      "#include \"include.h\"\nkernel void f(global int *p) { *p = X; }",
+      "#define X 1\n", Blob};
+  size_t Sizes[NUM_OBJECTS] = {strlen(Contents[0]), strlen(Contents[1]),
+                               sizeof(Blob)};
+  char Padding[PADDING] = {0};
+  amd_comgr_data_t Data, Packed;
+  amd_comgr_data_set_t DataSet, DataSetUnpacked;
+  amd_comgr_status_t Status;
+  size_t I, Count, Size;
+  char *Bytes;
+  int Ret;
+
+  for (I = 0; I < sizeof(Blob); ++I) {
+    Blob[I] = (char)I;
+  }
+
+  Status = amd_comgr_create_data_set(&DataSet);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  for (I = 0; I < NUM_OBJECTS; ++I) {
+    addData(DataSet, Kinds[I], Names[I], Contents[I], Sizes[I]);
+  }
+
+  Status = amd_comgr_pack_data_set(DataSet, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_pack_data_set accepted a NULL result");
+  }
+
+  Status = amd_comgr_pack_data_set(DataSet, &Packed);
+  checkError(Status, "amd_comgr_pack_data_set");
+
+  Status = amd_comgr_get_data(Packed, &Size, NULL);
+  checkError(Status, "amd_comgr_get_data");
+  Bytes = (char *)malloc(Size);
+  if (!Bytes) {
+    fail("malloc failed");
+  }
+  Status = amd_comgr_get_data(Packed, &Size, Bytes);
+  checkError(Status, "amd_comgr_get_data");
+
+  // Write the pack after some padding, to unpack it from a slice of the file.
+  remove(FileName);
+#if defined(_WIN32) || defined(_WIN64)
+  int FD = _open(FileName, _O_CREAT | _O_RDWR | _O_BINARY);
+#else
+  int FD = open(FileName, O_CREAT | O_RDWR, 0755);
+#endif
+  if (FD < 0) {
+    fail("open failed for %s with errno %d", FileName, errno);
+  }
+  if (WriteFile(FD, Padding, PADDING) != PADDING ||
+      WriteFile(FD, Bytes, Size) != Size) {
+    fail("write failed for %s", FileName);
+  }
+
+  Status = amd_comgr_create_data_set(&DataSetUnpacked);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  // The padding is not a packed data set, and must leave the set unchanged.
+  Status = amd_comgr_unpack_data_set(FD, 0, PADDING + Size, DataSetUnpacked);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_unpack_data_set accepted an invalid pack");
+  }
+  // A truncated pack must be rejected as well.
+  Status = amd_comgr_unpack_data_set(FD, PADDING, Size - 1, DataSetUnpacked);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_unpack_data_set accepted a truncated pack");
+  }
+  Status = amd_comgr_action_data_count(DataSetUnpacked,
+                                       AMD_COMGR_DATA_KIND_BYTES, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 0) {
+    fail("amd_comgr_unpack_data_set modified the data set on failure");
+  }
+
+  Status = amd_comgr_unpack_data_set(FD, PADDING, Size, DataSetUnpacked);
+  checkError(Status, "amd_comgr_unpack_data_set");
+
+#if defined(_WIN32) || defined(_WIN64)
+  _close(FD);
+#else
+  close(FD);
+#endif
+
+  for (I = 0; I < NUM_OBJECTS; ++I) {
+    char Name[16];
+    char *Unpacked;
+    size_t NameSize;
+
+    Status = amd_comgr_action_data_count(DataSetUnpacked, Kinds[I], &Count);
+    checkError(Status, "amd_comgr_action_data_count");
+    if (Count != 1) {
+      fail("unpacked %zu objects of kind %d (expected 1)", Count, Kinds[I]);
+    }
+
+    Status = amd_comgr_action_data_get_data(DataSetUnpacked, Kinds[I], 0,
+                                            &Data);
+    checkError(Status, "amd_comgr_action_data_get_data");
+
+    Status = amd_comgr_get_data_name(Data, &NameSize, NULL);
+    checkError(Status, "amd_comgr_get_data_name");
+    if (NameSize > sizeof(Name)) {
+      fail("unpacked name is %zu bytes long (expected %s)", NameSize,
+           Names[I]);
+    }
+    Status = amd_comgr_get_data_name(Data, &NameSize, Name);
+    checkError(Status, "amd_comgr_get_data_name");
+    if (strcmp(Name, Names[I])) {
+      fail("unpacked name %s (expected %s)", Name, Names[I]);
+    }
+
+    Status = amd_comgr_get_data(Data, &Size, NULL);
+    checkError(Status, "amd_comgr_get_data");
+    if (Size != Sizes[I]) {
+      fail("unpacked %zu bytes for %s (expected %zu)", Size, Names[I],
+           Sizes[I]);
+    }
+    Unpacked = (char *)malloc(Size);
+    if (!Unpacked) {
+      fail("malloc failed");
+    }
+    Status = amd_comgr_get_data(Data, &Size, Unpacked);
+    checkError(Status, "amd_comgr_get_data");
+    if (memcmp(Unpacked, Contents[I], Size)) {
+      fail("unpacked contents of %s differ", Names[I]);
+    }
+    free(Unpacked);
+
+    Status = amd_comgr_release_data(Data);
+    checkError(Status, "amd_comgr_release_data");
+  }
+
+  free(Bytes);
+  Status = amd_comgr_release_data(Packed);
+  checkError(Status, "amd_comgr_release_data");
+  Status = amd_comgr_destroy_data_set(DataSetUnpacked);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSet);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  if ((Ret = remove(FileName)) != 0) {
+    fail("remove failed");
+  }
+
+  return 0;
+}
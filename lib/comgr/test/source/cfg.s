@@ -0,0 +1,17 @@
+	.text
+	.globl	loop
+	.p2align	8
+	.type	loop,@function
+loop:
+	s_mov_b32 s0, 0
+.LBB0_1:
+	s_add_u32 s0, s0, 1
+	s_cmp_lt_u32 s0, 16
+	s_cbranch_scc1 .LBB0_1
+	s_cmp_eq_u32 s1, 0
+	s_cbranch_scc0 .LBB0_3
+	s_mov_b32 s2, 1
+.LBB0_3:
+	s_endpgm
+.Lfunc_end0:
+	.size	loop, .Lfunc_end0-loop
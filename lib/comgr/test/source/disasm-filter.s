@@ -0,0 +1,27 @@
+	.text
+	.globl	first
+	.p2align	8
+	.type	first,@function
+first:
+	s_mov_b32 s0, 1
+	s_endpgm
+.Lfunc_end0:
+	.size	first, .Lfunc_end0-first
+
+	.globl	second
+	.p2align	8
+	.type	second,@function
+second:
+	s_mov_b32 s0, 2
+	s_endpgm
+.Lfunc_end1:
+	.size	second, .Lfunc_end1-second
+
+	.globl	third
+	.p2align	8
+	.type	third,@function
+third:
+	s_mov_b32 s0, 3
+	s_endpgm
+.Lfunc_end2:
+	.size	third, .Lfunc_end2-third
@@ -0,0 +1,205 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static amd_comgr_metadata_node_t lookup(amd_comgr_metadata_node_t Map,
+                                        const char *Key) {
+  amd_comgr_metadata_node_t Node;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_metadata_lookup(Map, Key, &Node);
+  checkError(Status, "amd_comgr_metadata_lookup");
+  return Node;
+}
+
+static unsigned long long lookupCount(amd_comgr_metadata_node_t Map,
+                                      const char *Key) {
+  amd_comgr_metadata_node_t Node = lookup(Map, Key);
+  amd_comgr_status_t Status;
+  char Buf[32];
+  size_t Size = sizeof(Buf);
+
+  Status = amd_comgr_get_metadata_string(Node, &Size, Buf);
+  checkError(Status, "amd_comgr_get_metadata_string");
+  Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+
+  return strtoull(Buf, NULL, 10);
+}
+
+static unsigned long long lookupNestedCount(amd_comgr_metadata_node_t Map,
+                                            const char *Key1,
+                                            const char *Key2) {
+  amd_comgr_metadata_node_t Node = lookup(Map, Key1);
+  unsigned long long Count = lookupCount(Node, Key2);
+  amd_comgr_status_t Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  return Count;
+}
+
+static size_t getMapSize(amd_comgr_metadata_node_t Map, const char *Key) {
+  amd_comgr_metadata_node_t Node = lookup(Map, Key);
+  amd_comgr_status_t Status;
+  size_t Size;
+
+  Status = amd_comgr_get_metadata_map_size(Node, &Size);
+  checkError(Status, "amd_comgr_get_metadata_map_size");
+  Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  return Size;
+}
+
+static void getStatistics(amd_comgr_data_t *Data,
+                          amd_comgr_metadata_node_t *Meta) {
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_get_statistics(Data);
+  checkError(Status, "amd_comgr_get_statistics");
+  Status = amd_comgr_get_data_metadata(*Data, Meta);
+  checkError(Status, "amd_comgr_get_data_metadata");
+}
+
+static void releaseStatistics(amd_comgr_data_t Data,
+                              amd_comgr_metadata_node_t Meta) {
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_destroy_metadata(Meta);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_release_data(Data);
+  checkError(Status, "amd_comgr_release_data");
+}
+
+static void ignoreSymbol(const char *Symbol, void *UserData) {}
+
+int main(int argc, char *argv[]) {
+  size_t Size, DebugSize;
+  char *Buf, *DebugBuf;
+  amd_comgr_data_t DataDebug, DataStats;
+  amd_comgr_data_set_t DataSetIn, DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_symbolizer_info_t Symbolizer;
+  amd_comgr_metadata_node_t Meta, Actions;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_get_statistics(NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_get_statistics accepted NULL");
+  }
+
+  Status = amd_comgr_reset_statistics();
+  checkError(Status, "amd_comgr_reset_statistics");
+
+  Size = setBuf(TEST_OBJ_DIR "/shared.so", &Buf);
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetIn, AMD_COMGR_DATA_KIND_EXECUTABLE, "shared.so", Buf, Size);
+
+  Status = amd_comgr_create_data_set(&DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX,
+                               DataAction, DataSetIn, DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+
+  // Symbolize twice with one code object, so its debug information is parsed
+  // once and then found in the cache.
+  DebugSize = setBuf(TEST_OBJ_DIR "/shared-debug.so", &DebugBuf);
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &DataDebug);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(DataDebug, DebugSize, DebugBuf);
+  checkError(Status, "amd_comgr_set_data");
+  Status = amd_comgr_create_symbolizer_info(DataDebug, ignoreSymbol,
+                                            &Symbolizer);
+  checkError(Status, "amd_comgr_create_symbolizer_info");
+  Status = amd_comgr_symbolize(Symbolizer, 5896, true, NULL);
+  checkError(Status, "amd_comgr_symbolize");
+  Status = amd_comgr_symbolize(Symbolizer, 5896, true, NULL);
+  checkError(Status, "amd_comgr_symbolize");
+
+  getStatistics(&DataStats, &Meta);
+  Actions = lookup(Meta, "actions");
+  if (getMapSize(Meta, "actions") != 1 ||
+      lookupNestedCount(Actions, "AMD_COMGR_ACTION_ANALYZE_INSTRUCTION_MIX",
+                        "success") != 1) {
+    fail("expected one successful instruction mix action");
+  }
+  if (lookupCount(Meta, "bytes_in") != Size ||
+      !lookupCount(Meta, "bytes_out")) {
+    fail("unexpected action input or output size");
+  }
+  {
+    amd_comgr_metadata_node_t Caches = lookup(Meta, "caches");
+    if (lookupNestedCount(Caches, "symbolizer", "misses") != 1 ||
+        lookupNestedCount(Caches, "symbolizer", "hits") != 1) {
+      fail("expected one symbolizer cache miss and one hit");
+    }
+    Status = amd_comgr_destroy_metadata(Caches);
+    checkError(Status, "amd_comgr_destroy_metadata");
+  }
+  Status = amd_comgr_destroy_metadata(Actions);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  releaseStatistics(DataStats, Meta);
+
+  // Resetting restarts every counter.
+  Status = amd_comgr_reset_statistics();
+  checkError(Status, "amd_comgr_reset_statistics");
+  getStatistics(&DataStats, &Meta);
+  if (getMapSize(Meta, "actions") || lookupCount(Meta, "bytes_in") ||
+      lookupCount(Meta, "temp_files") || lookupCount(Meta, "lld_invocations")) {
+    fail("statistics not reset");
+  }
+  releaseStatistics(DataStats, Meta);
+
+  Status = amd_comgr_destroy_symbolizer_info(Symbolizer);
+  checkError(Status, "amd_comgr_destroy_symbolizer_info");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_release_data(DataDebug);
+  checkError(Status, "amd_comgr_release_data");
+  free(DebugBuf);
+  free(Buf);
+
+  return 0;
+}
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static amd_comgr_metadata_node_t lookup(amd_comgr_metadata_node_t Map,
+                                        const char *Key) {
+  amd_comgr_metadata_node_t Node;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_metadata_lookup(Map, Key, &Node);
+  if (Status) {
+    return (amd_comgr_metadata_node_t){0};
+  }
+  return Node;
+}
+
+static int hasString(amd_comgr_metadata_node_t Map, const char *Key,
+                     const char *Value) {
+  amd_comgr_metadata_node_t Node = lookup(Map, Key);
+  amd_comgr_status_t Status;
+  char Buf[128];
+  size_t Size = sizeof(Buf);
+  int Match;
+
+  if (!Node.handle) {
+    return 0;
+  }
+  Status = amd_comgr_get_metadata_string(Node, &Size, Buf);
+  checkError(Status, "amd_comgr_get_metadata_string");
+  Match = Size <= sizeof(Buf) && !strcmp(Buf, Value);
+  Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  return Match;
+}
+
+static int hasKey(amd_comgr_metadata_node_t Map, const char *Key) {
+  amd_comgr_metadata_node_t Node = lookup(Map, Key);
+  amd_comgr_status_t Status;
+
+  if (!Node.handle) {
+    return 0;
+  }
+  Status = amd_comgr_destroy_metadata(Node);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  return 1;
+}
+
+// Return the number of diagnostics with the given severity and option, and
+// count the ones carrying a location and fix-its.
+static size_t countDiagnostics(amd_comgr_data_set_t DataSet,
+                               const char *Severity, const char *Option,
+                               size_t *WithLocation, size_t *WithFixIts) {
+  amd_comgr_data_t Data;
+  amd_comgr_metadata_node_t Diags;
+  amd_comgr_metadata_kind_t Kind;
+  amd_comgr_status_t Status;
+  size_t Count, Size, I, Found = 0;
+  char Name[32];
+  size_t NameSize;
+
+  Status = amd_comgr_action_data_count(DataSet, AMD_COMGR_DATA_KIND_DIAGNOSTIC,
+                                       &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    fail("expected one diagnostic data object, found %zu", Count);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSet, AMD_COMGR_DATA_KIND_DIAGNOSTIC, 0, &Data);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_get_data_name(Data, &NameSize, NULL);
+  checkError(Status, "amd_comgr_get_data_name");
+  if (NameSize > sizeof(Name)) {
+    fail("diagnostic data object name is %zu bytes long", NameSize);
+  }
+  Status = amd_comgr_get_data_name(Data, &NameSize, Name);
+  checkError(Status, "amd_comgr_get_data_name");
+  if (strcmp(Name, "comgr-diagnostics")) {
+    fail("unexpected diagnostic data object name %s", Name);
+  }
+
+  Status = amd_comgr_get_data_metadata(Data, &Diags);
+  checkError(Status, "amd_comgr_get_data_metadata");
+  Status = amd_comgr_get_metadata_kind(Diags, &Kind);
+  checkError(Status, "amd_comgr_get_metadata_kind");
+  if (Kind != AMD_COMGR_METADATA_KIND_LIST) {
+    fail("diagnostics are not a list");
+  }
+  Status = amd_comgr_get_metadata_list_size(Diags, &Size);
+  checkError(Status, "amd_comgr_get_metadata_list_size");
+
+  for (I = 0; I < Size; ++I) {
+    amd_comgr_metadata_node_t Diag;
+
+    Status = amd_comgr_index_list_metadata(Diags, I, &Diag);
+    checkError(Status, "amd_comgr_index_list_metadata");
+    if (!hasKey(Diag, "message")) {
+      fail("diagnostic without a message");
+    }
+    if (hasString(Diag, "severity", Severity) &&
+        (!Option || hasString(Diag, "option", Option))) {
+      ++Found;
+      if (hasKey(Diag, "file") && hasKey(Diag, "line") &&
+          hasKey(Diag, "column")) {
+        ++*WithLocation;
+      }
+    }
+    if (hasKey(Diag, "fixits")) {
+      ++*WithFixIts;
+    }
+    Status = amd_comgr_destroy_metadata(Diag);
+    checkError(Status, "amd_comgr_destroy_metadata");
+  }
+
+  Status = amd_comgr_destroy_metadata(Diags);
+  checkError(Status, "amd_comgr_destroy_metadata");
+  Status = amd_comgr_release_data(Data);
+  checkError(Status, "amd_comgr_release_data");
+  return Found;
+}
+
+static amd_comgr_status_t runAction(amd_comgr_action_kind_t ActionKind,
+                                    amd_comgr_action_info_t DataAction,
+                                    amd_comgr_data_kind_t Kind,
+                                    const char *Name, const char *Source,
+                                    amd_comgr_data_set_t *DataSetOut) {
+  amd_comgr_data_set_t DataSetIn;
+  amd_comgr_status_t Status, ActionStatus;
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetIn, Kind, Name, Source, strlen(Source));
+
+  Status = amd_comgr_create_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_create_data_set");
+  ActionStatus =
+      amd_comgr_do_action(ActionKind, DataAction, DataSetIn, *DataSetOut);
+
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  return ActionStatus;
+}
+
+int main(int argc, char *argv[]) {
+  const char *Warning = "kernel void f(global int *p) {\n"
+                        "  if (*p = 1)\n"
+                        "    *p = 2;\n"
+                        "}\n";
+  const char *Error = "kernel void f(global int *p) {\n"
+                      "  *p = q;\n"
+                      "}\n";
+  const char *Asm = "  s_invalid_instruction v0\n";
+  amd_comgr_data_set_t DataSetOut;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  size_t Count, WithLocation = 0, WithFixIts = 0;
+  bool StructuredDiagnostics;
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx900");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  Status = amd_comgr_action_info_get_structured_diagnostics(
+      DataAction, &StructuredDiagnostics);
+  checkError(Status, "amd_comgr_action_info_get_structured_diagnostics");
+  if (StructuredDiagnostics) {
+    fail("structured diagnostics enabled by default");
+  }
+  Status = amd_comgr_action_info_get_structured_diagnostics(DataAction, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_action_info_get_structured_diagnostics accepted NULL");
+  }
+
+  Status = amd_comgr_action_info_set_structured_diagnostics(DataAction, true);
+  checkError(Status, "amd_comgr_action_info_set_structured_diagnostics");
+
+  // A warning with a note suggesting parentheses as a fix-it.
+  Status = runAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction,
+                     AMD_COMGR_DATA_KIND_SOURCE, "warning.cl", Warning,
+                     &DataSetOut);
+  checkError(Status, "amd_comgr_do_action");
+  if (countDiagnostics(DataSetOut, "warning", "parentheses", &WithLocation,
+                       &WithFixIts) != 1 ||
+      WithLocation != 1 || !WithFixIts) {
+    fail("expected a -Wparentheses warning with a location and fix-its");
+  }
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  // Diagnostics are returned when the action fails, without a log.
+  WithLocation = 0;
+  Status = runAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction,
+                     AMD_COMGR_DATA_KIND_SOURCE, "error.cl", Error,
+                     &DataSetOut);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("compiling invalid source did not fail");
+  }
+  if (countDiagnostics(DataSetOut, "error", NULL, &WithLocation,
+                       &WithFixIts) != 1 ||
+      WithLocation != 1) {
+    fail("expected an error with a location");
+  }
+  Status =
+      amd_comgr_action_data_count(DataSetOut, AMD_COMGR_DATA_KIND_LOG, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count) {
+    fail("log returned without logging enabled");
+  }
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  // Assembler diagnostics are reported through a SourceMgr.
+  WithLocation = 0;
+  Status = runAction(AMD_COMGR_ACTION_ASSEMBLE_SOURCE_TO_RELOCATABLE,
+                     DataAction, AMD_COMGR_DATA_KIND_SOURCE, "error.s", Asm,
+                     &DataSetOut);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("assembling invalid source did not fail");
+  }
+  if (!countDiagnostics(DataSetOut, "error", NULL, &WithLocation,
+                        &WithFixIts) ||
+      !WithLocation) {
+    fail("expected an assembler error with a location");
+  }
+  Status = amd_comgr_destroy_data_set(DataSetOut);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+}
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Symbolize the same address from several threads, each with its own
+// symbolizer info object over its own copy of the code object, and with one
+// symbolizer info object shared by all threads. All of them share the cached
+// debug information, and must produce the same result.
+
+static const int NumThreads = 8;
+static const int NumQueries = 64;
+
+// An address in the kernel of shared-debug.so, as in symbolize_test.
+static const uint64_t Address = 5896;
+
+static void collectSymbol(const char *Symbol, void *UserData) {
+  *static_cast<std::string *>(UserData) = Symbol;
+}
+
+static std::string symbolize(amd_comgr_symbolizer_info_t Symbolizer) {
+  std::string Result;
+  amd_comgr_status_t Status =
+      amd_comgr_symbolize(Symbolizer, Address, true, &Result);
+  checkError(Status, "amd_comgr_symbolize");
+  return Result;
+}
+
+static amd_comgr_data_t createData(char *Buf, size_t Size) {
+  amd_comgr_data_t Data;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_create_data(AMD_COMGR_DATA_KIND_EXECUTABLE, &Data);
+  checkError(Status, "amd_comgr_create_data");
+  Status = amd_comgr_set_data(Data, Size, Buf);
+  checkError(Status, "amd_comgr_set_data");
+  return Data;
+}
+
+int main(int argc, char *argv[]) {
+  char *Buf;
+  size_t Size;
+  amd_comgr_data_t Data;
+  amd_comgr_symbolizer_info_t Shared;
+  amd_comgr_status_t Status;
+
+  Size = setBuf(TEST_OBJ_DIR "/shared-debug.so", &Buf);
+
+  Data = createData(Buf, Size);
+  Status = amd_comgr_create_symbolizer_info(Data, collectSymbol, &Shared);
+  checkError(Status, "amd_comgr_create_symbolizer_info");
+
+  std::string Expected = symbolize(Shared);
+  if (Expected.compare(0, 5, "bazzz")) {
+    fail("unexpected symbolization %s", Expected.c_str());
+  }
+
+  std::vector<std::thread> Threads;
+  std::vector<int> Mismatches(NumThreads);
+  for (int I = 0; I < NumThreads; ++I) {
+    Threads.emplace_back([&, I]() {
+      amd_comgr_data_t Copy = createData(Buf, Size);
+      amd_comgr_symbolizer_info_t Own;
+      amd_comgr_status_t Status =
+          amd_comgr_create_symbolizer_info(Copy, collectSymbol, &Own);
+      checkError(Status, "amd_comgr_create_symbolizer_info");
+
+      for (int J = 0; J < NumQueries; ++J) {
+        if (symbolize(J % 2 ? Own : Shared) != Expected) {
+          ++Mismatches[I];
+        }
+      }
+
+      Status = amd_comgr_destroy_symbolizer_info(Own);
+      checkError(Status, "amd_comgr_destroy_symbolizer_info");
+      Status = amd_comgr_release_data(Copy);
+      checkError(Status, "amd_comgr_release_data");
+    });
+  }
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+
+  for (int I = 0; I < NumThreads; ++I) {
+    if (Mismatches[I]) {
+      fail("thread %d got %d mismatching symbolizations", I, Mismatches[I]);
+    }
+  }
+
+  Status = amd_comgr_destroy_symbolizer_info(Shared);
+  checkError(Status, "amd_comgr_destroy_symbolizer_info");
+  Status = amd_comgr_release_data(Data);
+  checkError(Status, "amd_comgr_release_data");
+  free(Buf);
+
+  return 0;
+}
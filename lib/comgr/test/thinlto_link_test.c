@@ -0,0 +1,188 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void compile(amd_comgr_action_info_t DataAction, const char *Path,
+                    const char *Name, amd_comgr_action_kind_t Last,
+                    amd_comgr_data_set_t DataSetOut) {
+  amd_comgr_data_set_t DataSetIn, DataSetBc;
+  amd_comgr_status_t Status;
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, Path, Name);
+
+  if (Last == AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC) {
+    Status = amd_comgr_do_action(Last, DataAction, DataSetIn, DataSetOut);
+    checkError(Status, "amd_comgr_do_action");
+  } else {
+    doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction, DataSetIn,
+             &DataSetBc);
+    Status = amd_comgr_do_action(Last, DataAction, DataSetBc, DataSetOut);
+    checkError(Status, "amd_comgr_do_action");
+    Status = amd_comgr_destroy_data_set(DataSetBc);
+    checkError(Status, "amd_comgr_destroy_data_set");
+  }
+
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+}
+
+int main(int argc, char *argv[]) {
+  amd_comgr_data_set_t DataSetIn, DataSetBc, DataSetExec, DataSetMixed;
+  amd_comgr_action_info_t DataAction, DataActionNoIsa;
+  amd_comgr_data_t DataExec;
+  amd_comgr_symbol_t Symbol;
+  amd_comgr_status_t Status;
+  const char *BadOptions[] = {"-Wl,--thinlto-jobs=many"};
+  const char *Options[] = {"-Wl,--thinlto-jobs=2"};
+  size_t Count;
+
+  Status = amd_comgr_create_data_set(&DataSetIn);
+  checkError(Status, "amd_comgr_create_data_set");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source1.cl",
+          "source1.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_SOURCE, TEST_OBJ_DIR "/source2.cl",
+          "source2.cl");
+  addFile(DataSetIn, AMD_COMGR_DATA_KIND_INCLUDE, TEST_OBJ_DIR "/include-a.h",
+          "include-a.h");
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx803");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  doAction(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataAction, DataSetIn,
+           &DataSetBc);
+
+  Status = amd_comgr_create_data_set(&DataSetExec);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  Status = amd_comgr_create_action_info(&DataActionNoIsa);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE,
+                               DataActionNoIsa, DataSetBc, DataSetExec);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("Failed, ThinLTO link without an ISA name accepted\n");
+    exit(1);
+  }
+  Status = amd_comgr_destroy_action_info(DataActionNoIsa);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  Status = amd_comgr_action_info_set_option_list(DataAction, BadOptions, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE,
+                               DataAction, DataSetBc, DataSetExec);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    printf("Failed, invalid ThinLTO job count accepted\n");
+    exit(1);
+  }
+
+  // source1 calls source2, which is defined in the other module.
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE,
+                               DataAction, DataSetBc, DataSetExec);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_action_data_count(DataSetExec,
+                                       AMD_COMGR_DATA_KIND_EXECUTABLE, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    printf("AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE Failed: "
+           "produced %zu executable objects (expected 1)\n",
+           Count);
+    exit(1);
+  }
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetExec, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+
+  Status = amd_comgr_symbol_lookup(DataExec, "source1", &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+  Status = amd_comgr_symbol_lookup(DataExec, "source2", &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+
+  // helper is hidden and defined in bitcode, but only called from a
+  // relocatable input, so LTO must keep it for the final link.
+  Status = amd_comgr_create_data_set(&DataSetMixed);
+  checkError(Status, "amd_comgr_create_data_set");
+  compile(DataAction, TEST_OBJ_DIR "/thinlto-helper.cl", "thinlto-helper.cl",
+          AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC, DataSetMixed);
+  compile(DataAction, TEST_OBJ_DIR "/thinlto-caller.cl", "thinlto-caller.cl",
+          AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataSetMixed);
+
+  Status = amd_comgr_destroy_data_set(DataSetExec);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_create_data_set(&DataSetExec);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_LINK_BC_TO_EXECUTABLE,
+                               DataAction, DataSetMixed, DataSetExec);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_action_data_get_data(
+      DataSetExec, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &DataExec);
+  checkError(Status, "amd_comgr_action_data_get_data");
+  Status = amd_comgr_symbol_lookup(DataExec, "caller", &Symbol);
+  checkError(Status, "amd_comgr_symbol_lookup");
+  Status = amd_comgr_release_data(DataExec);
+  checkError(Status, "amd_comgr_release_data");
+
+  Status = amd_comgr_destroy_data_set(DataSetMixed);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetIn);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetExec);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int CallbackCount = 0;
+static amd_comgr_status_t CallbackStatus = AMD_COMGR_STATUS_ERROR;
+
+static void onOptimized(amd_comgr_tiered_compilation_t Compilation,
+                        amd_comgr_status_t Status, void *UserData) {
+  bool Done;
+
+  if (UserData != &CallbackCount) {
+    fail("unexpected user data");
+  }
+  if (amd_comgr_tiered_compilation_is_done(Compilation, &Done) || !Done) {
+    fail("optimized tier not done in its callback");
+  }
+  CallbackStatus = Status;
+  ++CallbackCount;
+}
+
+int main(int argc, char *argv[]) {
+  const char *Source = "kernel void f(global int *p, int n) {\n"
+                       "  for (int i = 0; i < n; ++i)\n"
+                       "    p[i] = i * i;\n"
+                       "}\n";
+  const char *Invalid = "invalid";
+  amd_comgr_data_set_t DataSetCl, DataSetInvalid, DataSetBc, DataSetFast,
+      DataSetOptimized;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_tiered_compilation_t Compilation;
+  amd_comgr_status_t Status;
+  const char *Options[] = {"-O3"};
+
+  Status = amd_comgr_create_data_set(&DataSetCl);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetCl, AMD_COMGR_DATA_KIND_SOURCE, "source.cl", Source,
+          strlen(Source));
+
+  Status = amd_comgr_create_data_set(&DataSetInvalid);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetInvalid, AMD_COMGR_DATA_KIND_SOURCE, "invalid.cl", Invalid,
+          strlen(Invalid));
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction,
+                                              "amdgcn-amd-amdhsa--gfx900");
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+  Status = amd_comgr_action_info_set_option_list(DataAction, Options, 1);
+  checkError(Status, "amd_comgr_action_info_set_option_list");
+
+  Status = amd_comgr_create_data_set(&DataSetBc);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC,
+                               DataAction, DataSetCl, DataSetBc);
+  checkError(Status, "amd_comgr_do_action");
+
+  Status = amd_comgr_create_data_set(&DataSetFast);
+  checkError(Status, "amd_comgr_create_data_set");
+
+  Status = amd_comgr_do_action_tiered(AMD_COMGR_ACTION_LINK_BC_TO_BC,
+                                      DataAction, DataSetBc, DataSetFast,
+                                      NULL, NULL, &Compilation);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_do_action_tiered accepted an unsupported action");
+  }
+  Status = amd_comgr_do_action_tiered(
+      AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction, DataSetBc,
+      DataSetFast, NULL, NULL, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_do_action_tiered accepted a NULL compilation");
+  }
+
+  // A failing fast tier does not start the optimized tier.
+  Status = amd_comgr_do_action_tiered(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC,
+                                      DataAction, DataSetInvalid, DataSetFast,
+                                      onOptimized, &CallbackCount,
+                                      &Compilation);
+  if (Status != AMD_COMGR_STATUS_ERROR) {
+    fail("fast tier of invalid source did not fail");
+  }
+  checkCount("Invalid fast tier", DataSetFast, AMD_COMGR_DATA_KIND_BC, 0);
+
+  Status = amd_comgr_do_action_tiered(
+      AMD_COMGR_ACTION_CODEGEN_BC_TO_RELOCATABLE, DataAction, DataSetBc,
+      DataSetFast, onOptimized, &CallbackCount, &Compilation);
+  checkError(Status, "amd_comgr_do_action_tiered");
+  checkCount("Fast tier", DataSetFast, AMD_COMGR_DATA_KIND_RELOCATABLE, 1);
+
+  // The optimized tier keeps its own copies of the inputs.
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  Status = amd_comgr_create_data_set(&DataSetOptimized);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_tiered_compilation_wait(Compilation, DataSetOptimized);
+  checkError(Status, "amd_comgr_tiered_compilation_wait");
+  checkCount("Optimized tier", DataSetOptimized,
+             AMD_COMGR_DATA_KIND_RELOCATABLE, 1);
+
+  Status = amd_comgr_destroy_tiered_compilation(Compilation);
+  checkError(Status, "amd_comgr_destroy_tiered_compilation");
+  if (CallbackCount != 1 || CallbackStatus != AMD_COMGR_STATUS_SUCCESS) {
+    fail("expected one successful callback, got %d", CallbackCount);
+  }
+
+  Status = amd_comgr_destroy_data_set(DataSetOptimized);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetFast);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetInvalid);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_data_set(DataSetCl);
+  checkError(Status, "amd_comgr_destroy_data_set");
+}
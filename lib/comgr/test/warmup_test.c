@@ -0,0 +1,117 @@
+/*******************************************************************************
+ *
+ * University of Illinois/NCSA
+ * Open Source License
+ *
+ * Copyright (c) 2018 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * with the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimers.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimers in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ *     * Neither the names of Advanced Micro Devices, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this Software without specific prior written permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#include "amd_comgr.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+  const char *IsaNames[] = {"amdgcn-amd-amdhsa--gfx900",
+                            "amdgcn-amd-amdhsa--gfx90a:xnack+"};
+  const char *InvalidIsaNames[] = {"amdgcn-amd-amdhsa--gfx900",
+                                   "amdgcn-amd-amdhsa--gfx"};
+  amd_comgr_language_t Languages[] = {AMD_COMGR_LANGUAGE_OPENCL_1_2,
+                                      AMD_COMGR_LANGUAGE_HIP};
+  amd_comgr_language_t InvalidLanguages[] = {
+      (amd_comgr_language_t)(AMD_COMGR_LANGUAGE_LAST + 1)};
+  amd_comgr_data_set_t DataSetCl, DataSetBc;
+  amd_comgr_action_info_t DataAction;
+  amd_comgr_status_t Status;
+  size_t Count;
+
+  Status = amd_comgr_warmup(2, NULL, 0, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_warmup accepted NULL isa names");
+  }
+  Status = amd_comgr_warmup(0, NULL, 2, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_warmup accepted NULL languages");
+  }
+  Status = amd_comgr_warmup(2, InvalidIsaNames, 0, NULL);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_warmup accepted an invalid isa name");
+  }
+  Status = amd_comgr_warmup(0, NULL, 1, InvalidLanguages);
+  if (Status != AMD_COMGR_STATUS_ERROR_INVALID_ARGUMENT) {
+    fail("amd_comgr_warmup accepted an invalid language");
+  }
+
+  Status = amd_comgr_warmup(0, NULL, 0, NULL);
+  checkError(Status, "amd_comgr_warmup");
+  Status = amd_comgr_warmup(2, IsaNames, 2, Languages);
+  checkError(Status, "amd_comgr_warmup");
+
+  // Compile while the warm-up may still be running.
+  Status = amd_comgr_create_data_set(&DataSetCl);
+  checkError(Status, "amd_comgr_create_data_set");
+  addData(DataSetCl, AMD_COMGR_DATA_KIND_SOURCE, "source.cl", KernelSource,
+          strlen(KernelSource));
+
+  Status = amd_comgr_create_action_info(&DataAction);
+  checkError(Status, "amd_comgr_create_action_info");
+  Status = amd_comgr_action_info_set_language(DataAction,
+                                              AMD_COMGR_LANGUAGE_OPENCL_1_2);
+  checkError(Status, "amd_comgr_action_info_set_language");
+  Status = amd_comgr_action_info_set_isa_name(DataAction, IsaNames[0]);
+  checkError(Status, "amd_comgr_action_info_set_isa_name");
+
+  Status = amd_comgr_create_data_set(&DataSetBc);
+  checkError(Status, "amd_comgr_create_data_set");
+  Status = amd_comgr_do_action(AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC,
+                               DataAction, DataSetCl, DataSetBc);
+  checkError(Status, "amd_comgr_do_action");
+  Status =
+      amd_comgr_action_data_count(DataSetBc, AMD_COMGR_DATA_KIND_BC, &Count);
+  checkError(Status, "amd_comgr_action_data_count");
+  if (Count != 1) {
+    fail("AMD_COMGR_ACTION_COMPILE_SOURCE_TO_BC Failed: produced %zu BC "
+         "objects (expected 1)",
+         Count);
+  }
+
+  Status = amd_comgr_destroy_data_set(DataSetBc);
+  checkError(Status, "amd_comgr_destroy_data_set");
+  Status = amd_comgr_destroy_action_info(DataAction);
+  checkError(Status, "amd_comgr_destroy_action_info");
+  Status = amd_comgr_destroy_data_set(DataSetCl);
+  checkError(Status, "amd_comgr_destroy_data_set");
+
+  // Start another warm-up and exit without waiting for it.
+  Status = amd_comgr_warmup(2, IsaNames, 2, Languages);
+  checkError(Status, "amd_comgr_warmup");
+}